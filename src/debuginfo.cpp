@@ -4,35 +4,38 @@
 // Public domain.
 
 #include "debuginfo.hpp"
-#include <stdarg.h>
+#include "parallel.hpp"
+#include "radixsort.hpp"
+#include "stats.hpp"
 #include <algorithm>
-#include <map>
 #include <string.h>
 
-uint32_t DebugInfo::CountSizeInSection(SectionType type) const
+size_t DebugInfo::GetSymbolCount() const
 {
-    uint32_t size = 0;
-    for (const auto& sym : m_Symbols)
-    {
-        if (sym.sectionType == type)
-            size += sym.size;
-    }
-    return size;
+    size_t count = 0;
+    for (const auto& syms : m_Symbols)
+        count += syms.GetCount();
+    return count;
 }
 
-static bool StripTemplateParams(std::string& str)
+// Single pass over the name; out is only written to for templates, and is meant to be
+// reused between calls.
+bool StripTemplateParams(const char* name, std::string& out)
 {
-    bool isTemplate = false;
-    size_t start = str.find('<', 0);
-    while (start != std::string::npos)
+    const char* start = strchr(name, '<');
+    if (start == nullptr)
+        return false;
+
+    out.clear();
+    const char* pos = name;
+    while (start != nullptr)
     {
-        isTemplate = true;
         // scan to matching closing '>'
-        size_t i = start + 1;
+        const char* end = start + 1;
         int depth = 1;
-        while (i < str.size())
+        while (*end)
         {
-            char ch = str[i];
+            char ch = *end;
             if (ch == '<')
                 ++depth;
             if (ch == '>')
@@ -41,61 +44,85 @@ static bool StripTemplateParams(std::string& str)
                 if (depth == 0)
                     break;
             }
-            ++i;
+            ++end;
         }
         if (depth != 0)
-            return isTemplate; // no matching '>', just return
-
-        str = str.erase(start, i - start + 1);
+            break; // no matching '>', keep the rest as is
 
-        start = str.find('<', start);
+        out.append(pos, start - pos);
+        pos = end + 1;
+        start = strchr(pos, '<');
     }
+    out.append(pos);
+    return true;
+}
 
-    return isTemplate;
+// Returns per string ID table entry, growing the table as needed.
+template <typename T>
+static T& StringSlot(std::vector<T>& table, uint32_t id, const T& defaultValue)
+{
+    if (id >= table.size())
+        table.resize(std::max<size_t>(id + 1, table.size() * 2), defaultValue);
+    return table[id];
 }
 
-void DebugInfo::ComputeDerivedData()
+void DebugInfo::AddTemplate(uint32_t nameId, uint32_t size, uint32_t count)
 {
-    std::map<std::string, int> templateToIndex;
+    int32_t& index = StringSlot(m_StringToTemplate, nameId, -1);
+    if (index >= 0)
+    {
+        m_Templates[index].size += size;
+        m_Templates[index].count += count;
+    }
+    else
+    {
+        index = int32_t(m_Templates.size());
+        TemplateInfo info;
+        info.nameId = nameId;
+        info.count = count;
+        info.size = size;
+        m_Templates.emplace_back(info);
+    }
+}
 
-    for (const auto& sym : m_Symbols)
+// Below this many symbols threads are not worth starting.
+static const size_t kParallelDerivedDataMinSymbols = 100000;
+
+void DebugInfo::ComputeDerivedData(int threadCount)
+{
+    StatsSetCounter("symbols", GetSymbolCount());
+    if (threadCount > 1 && GetSymbolCount() >= kParallelDerivedDataMinSymbols)
+        ComputeDerivedDataParallel(threadCount);
+    else
+        ComputeDerivedDataSerial();
+}
+
+void DebugInfo::ComputeDerivedDataSerial()
+{
+    std::string templateName;
+    for (int type = 0; type < kSectionTypeCount; ++type)
     {
-        // aggregate templates
-        std::string templateName = sym.name;
-        bool isTemplate = StripTemplateParams(templateName);
-        if (isTemplate)
+        const SymbolTable& syms = m_Symbols[type];
+        for (size_t i = 0, n = syms.GetCount(); i < n; ++i)
         {
-            auto it = templateToIndex.find(templateName);
-            int index;
-            if (it != templateToIndex.end())
+            const uint32_t size = syms.size[i];
+
+            // aggregate templates
+            if (StripTemplateParams(GetString(syms.nameId[i]), templateName))
+                AddTemplate(m_Strings.Intern(templateName.data(), templateName.size()), size, 1);
+
+            // aggregate object file / namespace sizes
+            if (SectionType(type) == SectionType::Code)
             {
-                index = it->second;
-                m_Templates[index].size += sym.size;
-                m_Templates[index].count++;
+                m_ObjectFiles[syms.objectFileIndex[i]].codeSize += size;
+                m_Namespaces[syms.namespaceIndex[i]].codeSize += size;
             }
-            else
+            else if (SectionType(type) == SectionType::Data)
             {
-                index = int(m_Templates.size());
-                templateToIndex.insert(std::make_pair(templateName, index));
-                TemplateInfo info;
-                info.name = templateName;
-                info.count = 1;
-                info.size = sym.size;
-                m_Templates.emplace_back(info);
+                m_ObjectFiles[syms.objectFileIndex[i]].dataSize += size;
+                m_Namespaces[syms.namespaceIndex[i]].dataSize += size;
             }
         }
-
-        // aggregate object file / namespace sizes
-        if (sym.sectionType == SectionType::Code)
-        {
-            m_ObjectFiles[sym.objectFileIndex].codeSize += sym.size;
-            m_Namespaces[sym.namespaceIndex].codeSize += sym.size;
-        }
-        else if (sym.sectionType == SectionType::Data)
-        {
-            m_ObjectFiles[sym.objectFileIndex].dataSize += sym.size;
-            m_Namespaces[sym.namespaceIndex].dataSize += sym.size;
-        }
     }
 
     for (const auto& ctr : m_Contribs)
@@ -112,309 +139,793 @@ void DebugInfo::ComputeDerivedData()
     }
 }
 
-static void splitPath(const std::string& path, std::string& outDir, std::string& outFile)
+// Sums over one contiguous chunk of symbols and contributions.
+struct DerivedDataPartial
 {
-    size_t pos = path.find_last_of("/\\");
-    if (pos != std::string::npos)
+    std::vector<uint32_t> objectCodeSize, objectDataSize;
+    std::vector<uint32_t> objectContribCodeSize, objectContribDataSize;
+    std::vector<uint32_t> namespaceCodeSize, namespaceDataSize;
+    // templates in order of first appearance in the chunk, names in the chunk's own pool
+    StringPool templateNames;
+    std::vector<TemplateInfo> templates;
+};
+
+void DebugInfo::ComputeDerivedDataParallel(int threadCount)
+{
+    const size_t chunkCount = size_t(threadCount);
+    // symbol chunks are over all sections one after another
+    size_t sectionStart[kSectionTypeCount + 1] = {};
+    for (int type = 0; type < kSectionTypeCount; ++type)
+        sectionStart[type + 1] = sectionStart[type] + m_Symbols[type].GetCount();
+    const size_t symbolCount = sectionStart[kSectionTypeCount];
+    const size_t contribCount = m_Contribs.size();
+    std::vector<DerivedDataPartial> partials(chunkCount);
+    ParallelFor(threadCount, chunkCount, 1, [&](size_t chunk, int)
     {
-        outDir = path.substr(0, pos);
-        outFile = path.substr(pos + 1);
-    }
-    else
+        DerivedDataPartial& part = partials[chunk];
+        part.objectCodeSize.resize(m_ObjectFiles.size());
+        part.objectDataSize.resize(m_ObjectFiles.size());
+        part.objectContribCodeSize.resize(m_ObjectFiles.size());
+        part.objectContribDataSize.resize(m_ObjectFiles.size());
+        part.namespaceCodeSize.resize(m_Namespaces.size());
+        part.namespaceDataSize.resize(m_Namespaces.size());
+
+        std::string templateName;
+        const size_t symBegin = symbolCount * chunk / chunkCount, symEnd = symbolCount * (chunk + 1) / chunkCount;
+        int type = 0;
+        for (size_t i = symBegin; i < symEnd; ++i)
+        {
+            while (i >= sectionStart[type + 1])
+                ++type;
+            const SymbolTable& syms = m_Symbols[type];
+            const size_t row = i - sectionStart[type];
+            const uint32_t size = syms.size[row];
+            if (StripTemplateParams(GetString(syms.nameId[row]), templateName))
+            {
+                const uint32_t nameId = part.templateNames.Intern(templateName.data(), templateName.size());
+                if (nameId == part.templates.size())
+                {
+                    TemplateInfo info;
+                    info.nameId = nameId;
+                    part.templates.emplace_back(info);
+                }
+                part.templates[nameId].size += size;
+                part.templates[nameId].count++;
+            }
+
+            if (SectionType(type) == SectionType::Code)
+            {
+                part.objectCodeSize[syms.objectFileIndex[row]] += size;
+                part.namespaceCodeSize[syms.namespaceIndex[row]] += size;
+            }
+            else if (SectionType(type) == SectionType::Data)
+            {
+                part.objectDataSize[syms.objectFileIndex[row]] += size;
+                part.namespaceDataSize[syms.namespaceIndex[row]] += size;
+            }
+        }
+
+        const size_t ctrBegin = contribCount * chunk / chunkCount, ctrEnd = contribCount * (chunk + 1) / chunkCount;
+        for (size_t i = ctrBegin; i < ctrEnd; ++i)
+        {
+            const ContribInfo& ctr = m_Contribs[i];
+            if (ctr.sectionType == SectionType::Code)
+                part.objectContribCodeSize[ctr.objectFileIndex] += ctr.size;
+            else if (ctr.sectionType == SectionType::Data)
+                part.objectContribDataSize[ctr.objectFileIndex] += ctr.size;
+        }
+    });
+
+    // Merge in chunk order: templates then get added in the same order, with the same
+    // string IDs, as in a serial pass.
+    for (const DerivedDataPartial& part : partials)
     {
-        outDir = "";
-        outFile = path;
+        for (size_t i = 0, n = m_ObjectFiles.size(); i < n; ++i)
+        {
+            ObjectFileInfo& obj = m_ObjectFiles[i];
+            obj.codeSize += part.objectCodeSize[i];
+            obj.dataSize += part.objectDataSize[i];
+            obj.contribCodeSize += part.objectContribCodeSize[i];
+            obj.contribDataSize += part.objectContribDataSize[i];
+        }
+        for (size_t i = 0, n = m_Namespaces.size(); i < n; ++i)
+        {
+            m_Namespaces[i].codeSize += part.namespaceCodeSize[i];
+            m_Namespaces[i].dataSize += part.namespaceDataSize[i];
+        }
+        for (const TemplateInfo& tpl : part.templates)
+        {
+            const uint32_t nameId = m_Strings.Intern(part.templateNames.GetString(tpl.nameId), part.templateNames.GetLength(tpl.nameId));
+            AddTemplate(nameId, tpl.size, tpl.count);
+        }
     }
 }
 
 int32_t DebugInfo::GetObjectFileIndex(const char* pathStr)
 {
-    std::string path = pathStr;
-    auto it = m_ObjectPathToIndex.find(path);
-    if (it != m_ObjectPathToIndex.end())
-        return it->second;
-
-    std::string dir, file;
-    splitPath(path, dir, file);
+    const uint32_t pathId = m_Strings.Intern(pathStr);
+    const int32_t existing = StringSlot(m_StringToObjectFile, pathId, -1);
+    if (existing >= 0)
+        return existing;
+
+    // split into folder and file name
+    const char* path = m_Strings.GetString(pathId);
+    const char* sep = nullptr;
+    for (const char* p = path; *p; ++p)
+    {
+        if (*p == '/' || *p == '\\')
+            sep = p;
+    }
+    if (sep == nullptr)
+        return AddObjectFile(pathId, m_Strings.InternBorrowed(""), pathId);
+    const uint32_t fileDirId = m_Strings.Intern(path, sep - path);
+    const uint32_t fileNameId = m_Strings.Intern(sep + 1);
+    return AddObjectFile(pathId, fileDirId, fileNameId);
+}
 
+int32_t DebugInfo::AddObjectFile(uint32_t pathId, uint32_t fileDirId, uint32_t fileNameId)
+{
     ObjectFileInfo info;
-    info.fileDir = dir;
-    info.fileName = file;
+    info.pathId = pathId;
+    info.fileDirId = fileDirId;
+    info.fileNameId = fileNameId;
 
-    int32_t index = int32_t(m_ObjectPathToIndex.size());
+    int32_t index = int32_t(m_ObjectFiles.size());
     info.index = index;
-
     m_ObjectFiles.emplace_back(info);
-    m_ObjectPathToIndex.insert(it, {path, index});
-    m_ObjectNameToFolders[file].insert(dir);
+    StringSlot(m_StringToObjectFile, pathId, -1) = index;
+
+    ObjectNameFolders& folders = StringSlot(m_ObjectNameToFolders, fileNameId, ObjectNameFolders());
+    if (folders.firstDirId == ~0u)
+        folders.firstDirId = fileDirId;
+    else if (folders.firstDirId != fileDirId)
+        folders.multipleDirs = true;
     return index;
 }
 
-std::string DebugInfo::GetObjectFileDesc(int index) const
+void DebugInfo::UpdateObjectFileDescs()
 {
-    const ObjectFileInfo& info = m_ObjectFiles[index];
-    const auto it = m_ObjectNameToFolders.find(info.fileName);
-    if (it == m_ObjectNameToFolders.end() || it->second.size() < 2)
-        return info.fileName;
-    return info.fileName + " (" + info.fileDir + ")";
+    // any new object file can make the names of earlier ones ambiguous; redo all of them
+    if (m_ObjectFileDescs.size() == m_ObjectFiles.size())
+        return;
+    m_ObjectFileDescs.resize(m_ObjectFiles.size());
+    std::string desc;
+    for (const ObjectFileInfo& info : m_ObjectFiles)
+    {
+        uint32_t descId = info.fileNameId;
+        if (m_ObjectNameToFolders[info.fileNameId].multipleDirs)
+        {
+            desc.assign(GetString(info.fileNameId), m_Strings.GetLength(info.fileNameId));
+            desc += " (";
+            desc.append(GetString(info.fileDirId), m_Strings.GetLength(info.fileDirId));
+            desc += ")";
+            descId = m_Strings.Intern(desc.data(), desc.size());
+        }
+        m_ObjectFileDescs[info.index] = descId;
+    }
 }
 
-int32_t DebugInfo::GetNameSpaceIndex(const std::string& symName)
+int32_t DebugInfo::GetNameSpaceIndex(const char* symName)
 {
-    std::string space;
-    size_t pos = symName.rfind("::");
-    if (pos == std::string::npos || pos == 0)
-        space = "<global>";
+    const char* sep = nullptr;
+    for (const char* p = strstr(symName, "::"); p != nullptr; p = strstr(p + 1, "::"))
+        sep = p;
+
+    uint32_t spaceId;
+    if (sep == nullptr || sep == symName)
+        spaceId = m_Strings.InternBorrowed("<global>");
     else
-        space = symName.substr(0, pos);
+        spaceId = m_Strings.Intern(symName, sep - symName);
 
-    const auto it = m_NamespaceToIndex.find(space);
-    if (it != m_NamespaceToIndex.end())
-        return it->second;
+    const int32_t existing = StringSlot(m_StringToNamespace, spaceId, -1);
+    if (existing >= 0)
+        return existing;
+    return AddNamespace(spaceId);
+}
 
+int32_t DebugInfo::AddNamespace(uint32_t nameId)
+{
     NamespaceInfo info;
-    info.name = space;
+    info.nameId = nameId;
 
-    int32_t index = int32_t(m_NamespaceToIndex.size());
+    int32_t index = int32_t(m_Namespaces.size());
     info.index = index;
 
     m_Namespaces.emplace_back(info);
-    m_NamespaceToIndex.insert(it, { space, index });
+    StringSlot(m_StringToNamespace, nameId, -1) = index;
     return index;
 }
 
-static void sAppendPrintF(std::string &str, const char *format, ...)
+// Sorts items; when only the first topCount are wanted (non-zero), only sorts and keeps those.
+template <typename T, typename Less>
+static void SortTop(std::vector<T>& items, size_t topCount, Less less)
 {
-    static const int bufferSize = 512; // cut off after this
-    char buffer[bufferSize];
-    va_list arg;
-
-    va_start(arg, format);
-    vsnprintf(buffer, bufferSize - 1, format, arg);
-    va_end(arg);
-
-    strcpy(&buffer[bufferSize - 5], "...\n");
-    str += buffer;
+    if (topCount != 0 && topCount < items.size())
+    {
+        std::partial_sort(items.begin(), items.begin() + topCount, items.end(), less);
+        items.resize(topCount);
+    }
+    else
+    {
+        std::sort(items.begin(), items.end(), less);
+    }
 }
 
-std::string DebugInfo::WriteReport(const DebugFilters& filters)
+void DebugInfo::SelectReportRows(const DebugFilters& filters, ReportRows& rows)
 {
-    std::string Report;
-    const char* filterName = filters.name.empty() ? NULL : filters.name.c_str();
+    const NameFilter& filter = filters.nameFilter;
+    const bool filterNames = filter.IsActive();
+
+    StatsScope stats("object file names");
+    UpdateObjectFileDescs();
 
-    Report.reserve(64 * 1024);
-    if (filterName)
+    // name filter matches of each object file, evaluated once instead of for each of its symbols
+    std::vector<uint8_t> objectFileMatches;
+    if (filterNames)
     {
-        sAppendPrintF(Report, "Only including things with '%s' in their name/file\n\n", filterName);
+        objectFileMatches.resize(m_ObjectFiles.size());
+        for (size_t i = 0; i < m_ObjectFiles.size(); ++i)
+            objectFileMatches[i] = uint8_t(filter.Match(GetObjectFileDesc(int(i)), m_Strings.GetLength(m_ObjectFileDescs[i])));
     }
 
-    // symbols
-    sAppendPrintF(Report, "Functions by size (kilobytes, min %.2f):\n", filters.minFunction/1024.0);
-    std::sort(m_Symbols.begin(), m_Symbols.end(), [](const auto& a, const auto& b) {
-        if (a.size != b.size)
-            return a.size > b.size;
-        if (a.objectFileIndex != b.objectFileIndex)
-            return a.objectFileIndex < b.objectFileIndex;
-        return a.name < b.name;
-    });
+    // Rows of each list are picked first (size thresholds, name filter) and only those get sorted;
+    // with a top count only that many of them get sorted.
+    const size_t topCount = filters.topCount > 0 ? size_t(filters.topCount) : 0;
 
-    for (const auto& sym : m_Symbols)
+    // symbols
+    stats.Restart("symbols");
+    auto selectSymbols = [&](SectionType type, int minSize)
     {
-        if (sym.size < filters.minFunction)
-            break;
-        if (sym.sectionType == SectionType::Code)
+        const SymbolTable& syms = GetSymbols(type);
+        const size_t count = syms.GetCount();
+        std::vector<uint32_t>& symbols = rows.symbols[int(type)];
+
+        // rows over the size threshold; branch-free compaction over the size column
+        symbols.resize(count);
+        size_t rowCount = 0;
+        for (size_t i = 0; i < count; ++i)
         {
-            const char* name1 = sym.name.c_str();
-            std::string objFile = GetObjectFileDesc(sym.objectFileIndex);
-            if (filterName && !strstr(name1, filterName) && !strstr(objFile.c_str(), filterName))
-                continue;
-            sAppendPrintF(Report, "%5d.%02d: %-80s %s\n",
-                sym.size / 1024, (sym.size % 1024) * 100 / 1024,
-                name1, objFile.c_str());
+            symbols[rowCount] = uint32_t(i);
+            rowCount += syms.size[i] < minSize ? 0 : 1;
+        }
+        symbols.resize(rowCount);
+        if (filterNames)
+        {
+            symbols.erase(std::remove_if(symbols.begin(), symbols.end(), [&](uint32_t row) {
+                const uint32_t nameId = syms.nameId[row];
+                const uint32_t flags = filter.Match(GetString(nameId), m_Strings.GetLength(nameId)) | objectFileMatches[syms.objectFileIndex[row]];
+                return !filter.Accepts(flags);
+            }), symbols.end());
         }
-    }
 
-    // templates
-    sAppendPrintF(Report, "\nAggregated templates by size (kilobytes, min %.2f / %i):\n", filters.minTemplate/1024.0, filters.minTemplateCount);
-
-    std::sort(m_Templates.begin(), m_Templates.end(), [](const auto& a, const auto& b) {
-        if (a.size != b.size)
-            return a.size > b.size;
-        if (a.count != b.count)
-            return a.count > b.count;
-        return a.name < b.name;
-    });
+        // Sort row indices by size (largest first) with a radix sort, then order runs of equal
+        // size by object file and name; with a top count, only runs that make it to the top.
+        RadixSort32(symbols, [&](uint32_t row) { return ~syms.size[row]; });
+        size_t endRow = symbols.size();
+        if (topCount != 0 && topCount < endRow)
+            endRow = topCount;
+        for (size_t runStart = 0; runStart < endRow; )
+        {
+            const uint32_t size = syms.size[symbols[runStart]];
+            size_t runEnd = runStart + 1;
+            while (runEnd < symbols.size() && syms.size[symbols[runEnd]] == size)
+                ++runEnd;
+            if (runEnd - runStart > 1)
+            {
+                std::sort(symbols.begin() + runStart, symbols.begin() + runEnd, [&](uint32_t a, uint32_t b) {
+                    if (syms.objectFileIndex[a] != syms.objectFileIndex[b])
+                        return syms.objectFileIndex[a] < syms.objectFileIndex[b];
+                    return strcmp(GetString(syms.nameId[a]), GetString(syms.nameId[b])) < 0;
+                });
+            }
+            runStart = runEnd;
+        }
+        symbols.resize(endRow);
+    };
+    selectSymbols(SectionType::Code, filters.minFunction);
+    selectSymbols(SectionType::Data, filters.minData);
+    selectSymbols(SectionType::BSS, filters.minData);
 
+    // templates
+    stats.Restart("templates");
     for (const auto& tpl : m_Templates)
     {
-        if (tpl.size < filters.minTemplate)
-            break;
-        if (tpl.count < filters.minTemplateCount)
+        if (tpl.size < filters.minTemplate || tpl.count < filters.minTemplateCount)
             continue;
-        const char* name1 = tpl.name.c_str();
-        if (filterName && !strstr(name1, filterName))
+        if (filterNames && !filter.Accepts(filter.Match(GetString(tpl.nameId), m_Strings.GetLength(tpl.nameId))))
             continue;
-        sAppendPrintF(Report, "%5d.%02d #%5d: %s\n",
-            tpl.size / 1024, (tpl.size % 1024) * 100 / 1024,
-            tpl.count,
-            name1);
+        rows.templates.push_back(&tpl);
     }
+    SortTop(rows.templates, topCount, [this](const TemplateInfo* a, const TemplateInfo* b) {
+        if (a->size != b->size)
+            return a->size > b->size;
+        if (a->count != b->count)
+            return a->count > b->count;
+        return strcmp(GetString(a->nameId), GetString(b->nameId)) < 0;
+    });
+
+    // namespaces
+    stats.Restart("namespaces");
+    for (const auto& n : m_Namespaces)
+    {
+        if (n.codeSize >= filters.minClass && (!filterNames || filter.Accepts(filter.Match(GetString(n.nameId), m_Strings.GetLength(n.nameId)))))
+            rows.namespaces.push_back(&n);
+    }
+    SortTop(rows.namespaces, topCount, [this](const NamespaceInfo* a, const NamespaceInfo* b)
+    {
+        if (a->codeSize != b->codeSize)
+            return a->codeSize > b->codeSize;
+        if (a->dataSize != b->dataSize)
+            return a->dataSize > b->dataSize;
+        return strcmp(GetString(a->nameId), GetString(b->nameId)) < 0;
+    });
 
-    sAppendPrintF(Report, "\nData by size (kilobytes, min %.2f):\n", filters.minData/1024.0);
-    for (const auto& sym : m_Symbols)
+    // object files
+    stats.Restart("object files");
+    for (const auto& f : m_ObjectFiles)
     {
-        if (sym.size < filters.minData)
-            break;
-        if (sym.sectionType == SectionType::Data)
+        if (f.codeSize >= filters.minFile || f.contribCodeSize >= filters.minFile)
         {
-            const char* name1 = sym.name.c_str();
-            std::string objFile = GetObjectFileDesc(sym.objectFileIndex);
-            if (filterName && !strstr(name1, filterName) && !strstr(objFile.c_str(), filterName))
+            if (filterNames && !filter.Accepts(objectFileMatches[f.index]))
                 continue;
-            sAppendPrintF(Report, "%5d.%02d: %-50s %s\n",
-                sym.size / 1024, (sym.size % 1024) * 100 / 1024,
-                name1, objFile.c_str());
+            rows.codeObjectFiles.push_back(&f);
         }
     }
+    SortTop(rows.codeObjectFiles, topCount, [](const ObjectFileInfo* a, const ObjectFileInfo* b) {
+        if (a->contribCodeSize != b->contribCodeSize)
+            return a->contribCodeSize > b->contribCodeSize;
+        if (a->codeSize != b->codeSize)
+            return a->codeSize > b->codeSize;
+        return a->index < b->index;
+    });
 
-    sAppendPrintF(Report, "\nBSS by size (kilobytes, min %.2f):\n", filters.minData/1024.0);
-    for (const auto& sym : m_Symbols)
+    for (const auto& f : m_ObjectFiles)
     {
-        if (sym.size < filters.minData)
-            break;
-        if (sym.sectionType == SectionType::BSS)
+        if (f.dataSize >= filters.minFile || f.contribDataSize >= filters.minFile)
         {
-            const char* name1 = sym.name.c_str();
-            std::string objFile = GetObjectFileDesc(sym.objectFileIndex);
-            if (filterName && !strstr(name1, filterName) && !strstr(objFile.c_str(), filterName))
+            if (filterNames && !filter.Accepts(objectFileMatches[f.index]))
                 continue;
-            sAppendPrintF(Report, "%5d.%02d: %-50s %s\n",
-                sym.size / 1024, (sym.size % 1024) * 100 / 1024,
-                name1, objFile.c_str());
+            rows.dataObjectFiles.push_back(&f);
         }
     }
+    SortTop(rows.dataObjectFiles, topCount, [](const ObjectFileInfo* a, const ObjectFileInfo* b) {
+        if (a->contribDataSize != b->contribDataSize)
+            return a->contribDataSize > b->contribDataSize;
+        if (a->dataSize != b->dataSize)
+            return a->dataSize > b->dataSize;
+        return a->index < b->index;
+        });
 
-    sAppendPrintF(Report, "\nClasses/Namespaces by code size (kilobytes, min %.2f):\n", filters.minClass/1024.0);
-    std::vector<NamespaceInfo> nameSpaces;
-    for (const auto& n : m_Namespaces)
+    // totals
+    for (const auto& cnt : m_Contribs)
+        rows.contribSizes[int(cnt.sectionType)] += cnt.size;
+    static const char* kSectionNames[kSectionTypeCount] = { "other", "code", "data", "bss" };
+    for (int i = 0; i < kSectionTypeCount; ++i)
+        rows.sectionNameIds[i] = m_Strings.InternBorrowed(kSectionNames[i]);
+}
+
+void DebugInfo::WriteReport(const DebugFilters& filters, ReportFormat format, ReportWriter& out)
+{
+    ReportRows rows;
+    StatsScope stats("select rows");
+    SelectReportRows(filters, rows);
+    stats.Restart("write");
+    switch (format)
     {
-        if (n.codeSize >= filters.minClass)
-            nameSpaces.push_back(n);
+    case ReportFormat::Text: WriteTextReport(filters, rows, out); break;
+    case ReportFormat::JsonLines: WriteJsonLinesReport(rows, out); break;
+    case ReportFormat::Csv: WriteCsvReport(rows, out); break;
+    case ReportFormat::Binary: WriteBinaryReport(rows, out); break;
     }
-    std::sort(nameSpaces.begin(), nameSpaces.end(), [](const auto& a, const auto& b)
-    {
-        if (a.codeSize != b.codeSize)
-            return a.codeSize > b.codeSize;
-        if (a.dataSize != b.dataSize)
-            return a.dataSize > b.dataSize;
-        return a.name < b.name;
-    });
-    for (const auto& n : nameSpaces)
+}
+
+void DebugInfo::WriteTextReport(const DebugFilters& filters, const ReportRows& rows, ReportWriter& out) const
+{
+    if (filters.nameFilter.IsActive())
     {
-        const std::string& name = n.name;
-        if (filterName && !strstr(name.c_str(), filterName))
-            continue;
-        sAppendPrintF(Report, "%5d.%02d: %s\n",
-            n.codeSize / 1024, (n.codeSize % 1024) * 100 / 1024, name.c_str());
+        auto writePatterns = [&](const char* prefix, const std::vector<std::string>& patterns)
+        {
+            if (patterns.empty())
+                return;
+            std::string list;
+            for (const std::string& pattern : patterns)
+                list += (list.empty() ? "'" : " or '") + pattern + "'";
+            out.Printf("%s things with %s in their name/file\n", prefix, list.c_str());
+        };
+        writePatterns("Only including", filters.names);
+        writePatterns("Not including", filters.excludeNames);
+        out.Printf("\n");
     }
 
-    sAppendPrintF(Report, "\nObject files by code size (kilobytes, min %.2f):\n", filters.minFile/1024.0);
-    std::vector<ObjectFileInfo> objectFiles;
-    for (const auto& f : m_ObjectFiles)
+    // symbols
+    auto writeSymbols = [&](SectionType type, size_t nameWidth)
     {
-        if (f.codeSize >= filters.minFile || f.contribCodeSize >= filters.minFile)
-            objectFiles.push_back(f);
-    }
-    std::sort(objectFiles.begin(), objectFiles.end(), [](const ObjectFileInfo& a, const ObjectFileInfo& b) {
-        if (a.contribCodeSize != b.contribCodeSize)
-            return a.contribCodeSize > b.contribCodeSize;
-        if (a.codeSize != b.codeSize)
-            return a.codeSize > b.codeSize;
-        return a.index < b.index;
-    });
-    for (const auto& f : objectFiles)
+        const SymbolTable& syms = GetSymbols(type);
+        for (uint32_t row : rows.symbols[int(type)])
+        {
+            // "%5d.%02d: %-*s %s\n" of size in KB, name and object file
+            const uint32_t nameId = syms.nameId[row];
+            const uint32_t objFileId = GetObjectFileDescId(syms.objectFileIndex[row]);
+            out.BeginLine();
+            out.AppendKB(syms.size[row], 5);
+            out.Append(": ", 2);
+            out.AppendPadded(GetString(nameId), m_Strings.GetLength(nameId), nameWidth);
+            out.Append(' ');
+            out.Append(GetString(objFileId), m_Strings.GetLength(objFileId));
+            out.EndLine();
+        }
+    };
+
+    out.Printf("Functions by size (kilobytes, min %.2f):\n", filters.minFunction/1024.0);
+    writeSymbols(SectionType::Code, 80);
+
+    // templates
+    out.Printf("\nAggregated templates by size (kilobytes, min %.2f / %i):\n", filters.minTemplate/1024.0, filters.minTemplateCount);
+    for (const TemplateInfo* tpl : rows.templates)
     {
-        std::string objFile = GetObjectFileDesc(f.index);
-        if (filterName && !strstr(objFile.c_str(), filterName))
-            continue;
+        out.BeginLine();
+        out.AppendKB(tpl->size, 5);
+        out.Append(" #", 2);
+        out.AppendInt(tpl->count, 5);
+        out.Append(": ", 2);
+        out.Append(GetString(tpl->nameId), m_Strings.GetLength(tpl->nameId));
+        out.EndLine();
+    }
 
-        if (f.codeSize * 1.2f >= f.contribCodeSize)
+    out.Printf("\nData by size (kilobytes, min %.2f):\n", filters.minData/1024.0);
+    writeSymbols(SectionType::Data, 50);
+
+    out.Printf("\nBSS by size (kilobytes, min %.2f):\n", filters.minData/1024.0);
+    writeSymbols(SectionType::BSS, 50);
+
+    out.Printf("\nClasses/Namespaces by code size (kilobytes, min %.2f):\n", filters.minClass/1024.0);
+    for (const NamespaceInfo* n : rows.namespaces)
+    {
+        out.BeginLine();
+        out.AppendKB(n->codeSize, 5);
+        out.Append(": ", 2);
+        out.Append(GetString(n->nameId), m_Strings.GetLength(n->nameId));
+        out.EndLine();
+    }
+
+    auto writeObjectFile = [&](const ObjectFileInfo* f, uint32_t contribSize, uint32_t symbolSize)
+    {
+        const uint32_t objFileId = GetObjectFileDescId(f->index);
+        out.BeginLine();
+        out.AppendKB(contribSize, 5);
+        out.Append(": ", 2);
+        out.Append(GetString(objFileId), m_Strings.GetLength(objFileId));
+        if (symbolSize * 1.2f < contribSize)
         {
-            sAppendPrintF(Report, "%5d.%02d: %s\n",
-                f.contribCodeSize / 1024, (f.contribCodeSize % 1024) * 100 / 1024,
-                objFile.c_str());
+            out.Append(" [", 2);
+            out.AppendKB(symbolSize);
+            out.Append(" with symbols]");
         }
-        else
+        out.EndLine();
+    };
+
+    out.Printf("\nObject files by code size (kilobytes, min %.2f):\n", filters.minFile/1024.0);
+    for (const ObjectFileInfo* f : rows.codeObjectFiles)
+        writeObjectFile(f, f->contribCodeSize, f->codeSize);
+
+    out.Printf("\nObject files by data size (kilobytes, min %.2f):\n", filters.minFile / 1024.0);
+    for (const ObjectFileInfo* f : rows.dataObjectFiles)
+        writeObjectFile(f, f->contribDataSize, f->dataSize);
+
+
+    const uint32_t contribCodeSize = rows.contribSizes[int(SectionType::Code)];
+    const uint32_t contribDataSize = rows.contribSizes[int(SectionType::Data)];
+
+    uint32_t size;
+    size = CountSizeInSection(SectionType::Code);
+    out.Printf("\nOverall code:  %5d.%02d kb (%d.%02d with symbols)\n", contribCodeSize / 1024, (contribCodeSize % 1024) * 100 / 1024, size / 1024, (size % 1024) * 100 / 1024);
+
+    size = CountSizeInSection(SectionType::Data);
+    out.Printf("Overall data:  %5d.%02d kb (%d.%02d with symbols)\n", contribDataSize / 1024, (contribDataSize % 1024) * 100 / 1024, size / 1024, (size % 1024) * 100 / 1024);
+
+    size = CountSizeInSection(SectionType::BSS);
+    out.Printf("Overall BSS:   %5d.%02d kb\n", size / 1024,
+        (size % 1024) * 100 / 1024);
+
+    size = CountSizeInSection(SectionType::Unknown);
+    if (size > 0)
+    {
+        out.Printf("Overall other: %5d.%02d kb\n", size / 1024,
+            (size % 1024) * 100 / 1024);
+    }
+}
+
+// Columns of each machine readable report list.
+struct ReportListSchema
+{
+    const char* name;
+    int columnCount;
+    ReportColumn columns[4];
+};
+static const ReportListSchema kReportLists[kReportListCount] =
+{
+    { "functions", 4, { kColumnSize, kColumnName, kColumnObjectFile, kColumnNamespace } },
+    { "templates", 3, { kColumnSize, kColumnCount, kColumnName } },
+    { "data", 4, { kColumnSize, kColumnName, kColumnObjectFile, kColumnNamespace } },
+    { "bss", 4, { kColumnSize, kColumnName, kColumnObjectFile, kColumnNamespace } },
+    { "namespaces", 3, { kColumnCodeSize, kColumnDataSize, kColumnName } },
+    { "object_files_code", 3, { kColumnContribSize, kColumnSymbolSize, kColumnName } },
+    { "object_files_data", 3, { kColumnContribSize, kColumnSymbolSize, kColumnName } },
+    { "totals", 3, { kColumnName, kColumnContribSize, kColumnSymbolSize } },
+};
+static const char* kReportColumnNames[kReportColumnCount] =
+{
+    "name", "object_file", "namespace", "size", "count", "code_size", "data_size", "contrib_size", "symbol_size",
+};
+static bool IsStringColumn(ReportColumn column)
+{
+    return column == kColumnName || column == kColumnObjectFile || column == kColumnNamespace;
+}
+
+static SectionType SymbolListSection(ReportList list)
+{
+    return list == kReportFunctions ? SectionType::Code : list == kReportData ? SectionType::Data : SectionType::BSS;
+}
+
+size_t DebugInfo::GetReportRowCount(const ReportRows& rows, ReportList list) const
+{
+    switch (list)
+    {
+    case kReportFunctions:
+    case kReportData:
+    case kReportBSS: return rows.symbols[int(SymbolListSection(list))].size();
+    case kReportTemplates: return rows.templates.size();
+    case kReportNamespaces: return rows.namespaces.size();
+    case kReportObjectFilesCode: return rows.codeObjectFiles.size();
+    case kReportObjectFilesData: return rows.dataObjectFiles.size();
+    case kReportTotals: return kSectionTypeCount;
+    default: return 0;
+    }
+}
+
+uint32_t DebugInfo::GetReportValue(const ReportRows& rows, ReportList list, size_t index, ReportColumn column) const
+{
+    switch (list)
+    {
+    case kReportFunctions:
+    case kReportData:
+    case kReportBSS:
+    {
+        const SectionType type = SymbolListSection(list);
+        const SymbolTable& syms = GetSymbols(type);
+        const uint32_t row = rows.symbols[int(type)][index];
+        switch (column)
         {
-            sAppendPrintF(Report, "%5d.%02d: %s [%d.%02d with symbols]\n",
-                f.contribCodeSize / 1024, (f.contribCodeSize % 1024) * 100 / 1024,
-                objFile.c_str(),
-                f.codeSize / 1024, (f.codeSize % 1024) * 100 / 1024);
+        case kColumnName: return syms.nameId[row];
+        case kColumnObjectFile: return GetObjectFileDescId(syms.objectFileIndex[row]);
+        case kColumnNamespace: return m_Namespaces[syms.namespaceIndex[row]].nameId;
+        case kColumnSize: return syms.size[row];
+        default: return 0;
         }
     }
-
-    sAppendPrintF(Report, "\nObject files by data size (kilobytes, min %.2f):\n", filters.minFile / 1024.0);
-    objectFiles.clear();
-    for (const auto& f : m_ObjectFiles)
+    case kReportTemplates:
     {
-        if (f.dataSize >= filters.minFile || f.contribDataSize >= filters.minFile)
-            objectFiles.push_back(f);
-    }
-    std::sort(objectFiles.begin(), objectFiles.end(), [](const ObjectFileInfo& a, const ObjectFileInfo& b) {
-        if (a.contribDataSize != b.contribDataSize)
-            return a.contribDataSize > b.contribDataSize;
-        if (a.dataSize != b.dataSize)
-            return a.dataSize > b.dataSize;
-        return a.index < b.index;
-        });
-    for (const auto& f : objectFiles)
+        const TemplateInfo* tpl = rows.templates[index];
+        return column == kColumnName ? tpl->nameId : column == kColumnSize ? tpl->size : tpl->count;
+    }
+    case kReportNamespaces:
     {
-        std::string objFile = GetObjectFileDesc(f.index);
-        if (filterName && !strstr(objFile.c_str(), filterName))
-            continue;
+        const NamespaceInfo* n = rows.namespaces[index];
+        return column == kColumnName ? n->nameId : column == kColumnCodeSize ? n->codeSize : n->dataSize;
+    }
+    case kReportObjectFilesCode:
+    {
+        const ObjectFileInfo* f = rows.codeObjectFiles[index];
+        return column == kColumnName ? GetObjectFileDescId(f->index) : column == kColumnContribSize ? f->contribCodeSize : f->codeSize;
+    }
+    case kReportObjectFilesData:
+    {
+        const ObjectFileInfo* f = rows.dataObjectFiles[index];
+        return column == kColumnName ? GetObjectFileDescId(f->index) : column == kColumnContribSize ? f->contribDataSize : f->dataSize;
+    }
+    case kReportTotals:
+    {
+        // code, data, bss, other
+        const SectionType type = SectionType((index + 1) % kSectionTypeCount);
+        return column == kColumnName ? rows.sectionNameIds[int(type)] : column == kColumnContribSize ? rows.contribSizes[int(type)] : CountSizeInSection(type);
+    }
+    default:
+        return 0;
+    }
+}
 
-        if (f.dataSize * 1.2f >= f.contribDataSize)
+static void WriteJsonString(ReportWriter& out, const char* str, size_t length)
+{
+    static const char kHex[] = "0123456789abcdef";
+    out.Write('"');
+    size_t start = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        const uint8_t ch = uint8_t(str[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\')
+            continue;
+        out.Write(str + start, i - start);
+        start = i + 1;
+        if (ch == '"' || ch == '\\')
         {
-            sAppendPrintF(Report, "%5d.%02d: %s\n",
-                f.contribDataSize / 1024, (f.contribDataSize % 1024) * 100 / 1024,
-                objFile.c_str());
+            const char escaped[2] = { '\\', char(ch) };
+            out.Write(escaped, 2);
         }
         else
         {
-            sAppendPrintF(Report, "%5d.%02d: %s [%d.%02d with symbols]\n",
-                f.contribDataSize / 1024, (f.contribDataSize % 1024) * 100 / 1024,
-                objFile.c_str(),
-                f.dataSize / 1024, (f.dataSize % 1024) * 100 / 1024);
+            const char escaped[6] = { '\\', 'u', '0', '0', kHex[ch >> 4], kHex[ch & 15] };
+            out.Write(escaped, 6);
         }
     }
+    out.Write(str + start, length - start);
+    out.Write('"');
+}
 
+static void WriteCsvField(ReportWriter& out, const char* str, size_t length)
+{
+    if (strcspn(str, ",\"\r\n") >= length)
+    {
+        out.Write(str, length);
+        return;
+    }
+    out.Write('"');
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (str[i] == '"')
+            out.Write('"');
+        out.Write(str[i]);
+    }
+    out.Write('"');
+}
 
-    uint32_t contribCodeSize = 0, contribDataSize = 0;
-    for (const auto& cnt : m_Contribs)
+void DebugInfo::WriteJsonLinesReport(const ReportRows& rows, ReportWriter& out) const
+{
+    for (uint32_t l = 0; l < kReportListCount; ++l)
     {
-        if (cnt.sectionType == SectionType::Code)
-            contribCodeSize += cnt.size;
-        if (cnt.sectionType == SectionType::Data)
-            contribDataSize += cnt.size;
+        const ReportList list = ReportList(l);
+        const ReportListSchema& schema = kReportLists[list];
+        for (size_t i = 0, n = GetReportRowCount(rows, list); i < n; ++i)
+        {
+            out.Write("{\"list\":\"", 9);
+            out.Write(schema.name, strlen(schema.name));
+            out.Write('"');
+            for (int c = 0; c < schema.columnCount; ++c)
+            {
+                const ReportColumn column = schema.columns[c];
+                const uint32_t value = GetReportValue(rows, list, i, column);
+                out.Write(",\"", 2);
+                out.Write(kReportColumnNames[column], strlen(kReportColumnNames[column]));
+                out.Write("\":", 2);
+                if (IsStringColumn(column))
+                    WriteJsonString(out, GetString(value), m_Strings.GetLength(value));
+                else
+                    out.WriteInt(value);
+            }
+            out.Write("}\n", 2);
+        }
     }
+}
 
-    uint32_t size;
-    size = CountSizeInSection(SectionType::Code);
-    sAppendPrintF(Report, "\nOverall code:  %5d.%02d kb (%d.%02d with symbols)\n", contribCodeSize / 1024, (contribCodeSize % 1024) * 100 / 1024, size / 1024, (size % 1024) * 100 / 1024);
+void DebugInfo::WriteCsvReport(const ReportRows& rows, ReportWriter& out) const
+{
+    // all lists in one table; columns a list does not have are left empty
+    out.Write("list", 4);
+    for (const char* name : kReportColumnNames)
+    {
+        out.Write(',');
+        out.Write(name, strlen(name));
+    }
+    out.Write('\n');
 
-    size = CountSizeInSection(SectionType::Data);
-    sAppendPrintF(Report, "Overall data:  %5d.%02d kb (%d.%02d with symbols)\n", contribDataSize / 1024, (contribDataSize % 1024) * 100 / 1024, size / 1024, (size % 1024) * 100 / 1024);
+    for (uint32_t l = 0; l < kReportListCount; ++l)
+    {
+        const ReportList list = ReportList(l);
+        const ReportListSchema& schema = kReportLists[list];
+        for (size_t i = 0, n = GetReportRowCount(rows, list); i < n; ++i)
+        {
+            out.Write(schema.name, strlen(schema.name));
+            for (uint32_t column = 0; column < kReportColumnCount; ++column)
+            {
+                out.Write(',');
+                if (std::find(schema.columns, schema.columns + schema.columnCount, ReportColumn(column)) == schema.columns + schema.columnCount)
+                    continue;
+                const uint32_t value = GetReportValue(rows, list, i, ReportColumn(column));
+                if (IsStringColumn(ReportColumn(column)))
+                    WriteCsvField(out, GetString(value), m_Strings.GetLength(value));
+                else
+                    out.WriteInt(value);
+            }
+            out.Write('\n');
+        }
+    }
+}
 
-    size = CountSizeInSection(SectionType::BSS);
-    sAppendPrintF(Report, "Overall BSS:   %5d.%02d kb\n", size / 1024,
-        (size % 1024) * 100 / 1024);
+void DebugInfo::WriteBinaryReport(const ReportRows& rows, ReportWriter& out) const
+{
+    BinaryReportHeader header;
+    memcpy(header.magic, kBinaryReportMagic, sizeof(header.magic));
+    header.version = kBinaryReportVersion;
+    out.Write((const char*)&header, sizeof(header));
+
+    // string pool IDs to string table indices, assigned in order of first use
+    std::vector<uint32_t> stringIndices(m_Strings.GetCount(), ~0u);
+    std::vector<uint32_t> strings;
+
+    // columns, written in batches of values
+    std::vector<uint64_t> columnOffsets[kReportListCount];
+    uint32_t values[1024];
+    for (uint32_t l = 0; l < kReportListCount; ++l)
+    {
+        const ReportList list = ReportList(l);
+        const ReportListSchema& schema = kReportLists[list];
+        const size_t rowCount = GetReportRowCount(rows, list);
+        for (int c = 0; c < schema.columnCount; ++c)
+        {
+            const ReportColumn column = schema.columns[c];
+            const bool isString = IsStringColumn(column);
+            out.WritePadding(8);
+            columnOffsets[list].push_back(out.GetWrittenSize());
+            for (size_t start = 0; start < rowCount; start += 1024)
+            {
+                const size_t count = std::min<size_t>(rowCount - start, 1024);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    uint32_t value = GetReportValue(rows, list, start + i, column);
+                    if (isString)
+                    {
+                        uint32_t& index = stringIndices[value];
+                        if (index == ~0u)
+                        {
+                            index = uint32_t(strings.size());
+                            strings.push_back(value);
+                        }
+                        value = index;
+                    }
+                    values[i] = value;
+                }
+                out.Write((const char*)values, count * sizeof(values[0]));
+            }
+        }
+    }
 
-    size = CountSizeInSection(SectionType::Unknown);
-    if (size > 0)
+    // string table
+    BinaryReportFooter footer;
+    out.WritePadding(8);
+    footer.stringOffsetsOffset = out.GetWrittenSize();
+    uint32_t offset = 0;
+    for (uint32_t id : strings)
     {
-        sAppendPrintF(Report, "Overall other: %5d.%02d kb\n", size / 1024,
-            (size % 1024) * 100 / 1024);
+        out.Write((const char*)&offset, sizeof(offset));
+        offset += m_Strings.GetLength(id) + 1;
+    }
+    out.Write((const char*)&offset, sizeof(offset));
+    footer.stringDataOffset = out.GetWrittenSize();
+    for (uint32_t id : strings)
+        out.Write(GetString(id), m_Strings.GetLength(id) + 1);
+
+    // table descriptions
+    out.WritePadding(8);
+    footer.tablesOffset = out.GetWrittenSize();
+    for (uint32_t l = 0; l < kReportListCount; ++l)
+    {
+        const ReportListSchema& schema = kReportLists[l];
+        BinaryReportTable table = {};
+        table.list = l;
+        table.rowCount = uint32_t(GetReportRowCount(rows, ReportList(l)));
+        table.columnCount = uint32_t(schema.columnCount);
+        out.Write((const char*)&table, sizeof(table));
+        for (int c = 0; c < schema.columnCount; ++c)
+        {
+            BinaryReportColumn column = {};
+            column.column = schema.columns[c];
+            column.offset = columnOffsets[l][c];
+            out.Write((const char*)&column, sizeof(column));
+        }
     }
 
-    return Report;
+    footer.stringCount = uint32_t(strings.size());
+    footer.tableCount = kReportListCount;
+    memcpy(footer.magic, kBinaryReportMagic, sizeof(footer.magic));
+    footer.version = kBinaryReportVersion;
+    out.Write((const char*)&footer, sizeof(footer));
 }
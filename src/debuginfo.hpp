@@ -5,8 +5,11 @@
 
 #pragma once
 
-#include <map>
-#include <set>
+#include "namefilter.hpp"
+#include "reportformat.hpp"
+#include "reportwriter.hpp"
+#include "stringpool.hpp"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,16 +20,36 @@ enum class SectionType
     Data,
     BSS,
 };
+static const int kSectionTypeCount = 4;
 
 struct SymbolInfo
 {
-    std::string name;
+    uint32_t nameId = 0; // in DebugInfo string pool
     int32_t namespaceIndex = 0;
     int32_t objectFileIndex = 0;
     uint32_t size = 0;
     SectionType sectionType = SectionType::Unknown;
 };
 
+// Symbols (of one section type), stored as parallel columns, so that filtering and sorting
+// only touch the data they need.
+struct SymbolTable
+{
+    std::vector<uint32_t> size;
+    std::vector<int32_t> objectFileIndex;
+    std::vector<int32_t> namespaceIndex;
+    std::vector<uint32_t> nameId;
+
+    size_t GetCount() const { return size.size(); }
+    void Add(const SymbolInfo& sym)
+    {
+        size.push_back(sym.size);
+        objectFileIndex.push_back(sym.objectFileIndex);
+        namespaceIndex.push_back(sym.namespaceIndex);
+        nameId.push_back(sym.nameId);
+    }
+};
+
 struct ContribInfo
 {
     int32_t objectFileIndex = 0;
@@ -36,8 +59,9 @@ struct ContribInfo
 
 struct ObjectFileInfo
 {
-    std::string fileDir;
-    std::string fileName;
+    uint32_t pathId = 0;
+    uint32_t fileDirId = 0;
+    uint32_t fileNameId = 0;
     int32_t index = 0;
     uint32_t codeSize = 0;
     uint32_t dataSize = 0;
@@ -47,7 +71,7 @@ struct ObjectFileInfo
 
 struct NamespaceInfo
 {
-    std::string name;
+    uint32_t nameId = 0;
     int32_t index = 0;
     uint32_t  codeSize = 0;
     uint32_t  dataSize = 0;
@@ -55,51 +79,126 @@ struct NamespaceInfo
 
 struct TemplateInfo
 {
-    std::string name;
+    uint32_t nameId = 0;
     uint32_t size = 0;
     uint32_t count = 0;
 };
 
 struct DebugFilters
 {
-    DebugFilters() : minFunction(512), minData(1024), minClass(2048), minFile(2048), minTemplate(512), minTemplateCount(3) { }
+    DebugFilters() : minFunction(512), minData(1024), minClass(2048), minFile(2048), minTemplate(512), minTemplateCount(3), topCount(0) { }
     void SetMinSize(int m)
     {
         minFunction = minData = minClass = minFile = minTemplate = m;
     }
-    std::string name;
+    std::vector<std::string> names; // only include things matching any of these
+    std::vector<std::string> excludeNames; // leave out things matching any of these
+    NameFilter nameFilter; // compiled names / excludeNames
     int minFunction;
     int minData;
     int minClass;
     int minFile;
     int minTemplate;
     int minTemplateCount;
+    int topCount; // max. entries per report list, 0 for no limit
 };
 
+// Writes name with template parameters ("<...>" parts, including nested ones) removed
+// into out, and returns whether there were any.
+bool StripTemplateParams(const char* name, std::string& out);
+
+struct SnapshotKey;
+
 class DebugInfo
 {
 public:
-    std::vector<SymbolInfo>  m_Symbols;
     std::vector<ContribInfo> m_Contribs;
+    // Whatever memory borrowed symbol names point into (e.g. the mapped PDB file), kept
+    // alive for as long as the symbols are.
+    std::vector<std::shared_ptr<void>> m_NameStorage;
+
+    // Symbol names are not copied; they have to stay alive, see m_NameStorage.
+    uint32_t InternSymbolName(const char* name) { return m_Strings.InternBorrowed(name); }
+    const char* GetString(uint32_t id) const { return m_Strings.GetString(id); }
 
     int32_t GetObjectFileIndex(const char* pathStr);
-    int32_t GetNameSpaceIndex(const std::string& symName);
+    int32_t GetNameSpaceIndex(const char* symName);
 
-    void ComputeDerivedData();
+    void AddSymbol(const SymbolInfo& sym)
+    {
+        const int type = int(sym.sectionType);
+        m_Symbols[type].Add(sym);
+        m_SectionSizes[type] += sym.size;
+    }
+    const SymbolTable& GetSymbols(SectionType type) const { return m_Symbols[int(type)]; }
+    size_t GetSymbolCount() const;
 
-    std::string WriteReport(const DebugFilters& filters);
+    // Aggregates template, object file and namespace sizes. With more than one thread, each
+    // works on a chunk of symbols with its own partial sums, merged at the end; the result is
+    // identical to a single threaded run.
+    void ComputeDerivedData(int threadCount);
+
+    void WriteReport(const DebugFilters& filters, ReportFormat format, ReportWriter& out);
 
 private:
-    uint32_t CountSizeInSection(SectionType type) const;
-    std::string GetObjectFileDesc(int index) const;
+    // entries that go into each report list, in the order they are written
+    struct ReportRows
+    {
+        std::vector<uint32_t> symbols[kSectionTypeCount]; // SymbolTable row indices
+        std::vector<const TemplateInfo*> templates;
+        std::vector<const NamespaceInfo*> namespaces;
+        std::vector<const ObjectFileInfo*> codeObjectFiles;
+        std::vector<const ObjectFileInfo*> dataObjectFiles;
+        uint32_t contribSizes[kSectionTypeCount] = {};
+        uint32_t sectionNameIds[kSectionTypeCount] = {};
+    };
+
+    // snapshots save and restore everything read from a PDB
+    friend bool SaveSnapshot(const DebugInfo& info, const SnapshotKey& key, const char* path);
+    friend bool LoadSnapshot(const char* path, const SnapshotKey* expectedKey, DebugInfo& to, SnapshotKey* outKey);
+
+    int32_t AddObjectFile(uint32_t pathId, uint32_t fileDirId, uint32_t fileNameId);
+    int32_t AddNamespace(uint32_t nameId);
+    void ComputeDerivedDataSerial();
+    void ComputeDerivedDataParallel(int threadCount);
+    void AddTemplate(uint32_t nameId, uint32_t size, uint32_t count);
+    uint32_t CountSizeInSection(SectionType type) const { return m_SectionSizes[int(type)]; }
+    void UpdateObjectFileDescs();
+    void SelectReportRows(const DebugFilters& filters, ReportRows& rows);
+    void WriteTextReport(const DebugFilters& filters, const ReportRows& rows, ReportWriter& out) const;
+    void WriteJsonLinesReport(const ReportRows& rows, ReportWriter& out) const;
+    void WriteCsvReport(const ReportRows& rows, ReportWriter& out) const;
+    void WriteBinaryReport(const ReportRows& rows, ReportWriter& out) const;
+    // Rows and values of report lists, for the machine readable formats; string columns
+    // give string IDs.
+    size_t GetReportRowCount(const ReportRows& rows, ReportList list) const;
+    uint32_t GetReportValue(const ReportRows& rows, ReportList list, size_t index, ReportColumn column) const;
+    uint32_t GetObjectFileDescId(int index) const { return m_ObjectFileDescs[index]; }
+    const char* GetObjectFileDesc(int index) const { return GetString(m_ObjectFileDescs[index]); }
 
 private:
-    std::vector<NamespaceInfo> m_Namespaces;
-    std::map<std::string, int32_t> m_NamespaceToIndex;
+    // symbols bucketed by section type, and total size of each
+    SymbolTable m_Symbols[kSectionTypeCount];
+    uint32_t m_SectionSizes[kSectionTypeCount] = {};
+
+    // all names: symbols, namespaces, object file paths/dirs/names, templates
+    StringPool m_Strings;
+    // per string ID lookups, -1 when the string is not a namespace / object file path etc.
+    std::vector<int32_t> m_StringToNamespace;
+    std::vector<int32_t> m_StringToObjectFile;
+    std::vector<int32_t> m_StringToTemplate;
+    // per object file name string ID: folder it was first seen in, and whether it was seen in
+    // several folders (then the folder is printed to disambiguate)
+    struct ObjectNameFolders
+    {
+        uint32_t firstDirId = ~0u;
+        bool multipleDirs = false;
+    };
+    std::vector<ObjectNameFolders> m_ObjectNameToFolders;
+    // per object file: string ID of how it is printed (file name, plus folder when ambiguous)
+    std::vector<uint32_t> m_ObjectFileDescs;
 
+    std::vector<NamespaceInfo> m_Namespaces;
     std::vector<ObjectFileInfo> m_ObjectFiles;
-    std::map<std::string, int32_t> m_ObjectPathToIndex;
-    std::map<std::string, std::set<std::string>> m_ObjectNameToFolders;
-
     std::vector<TemplateInfo> m_Templates;
 };
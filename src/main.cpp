@@ -4,18 +4,30 @@
 // Public domain.
 
 #include "pdbfile.hpp"
+#include "parallel.hpp"
 #include "debuginfo.hpp"
+#include "reportwriter.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
 #include "pe_utils.hpp"
 #include "mmapfile.h"
 #include "parg.h"
 #include <cstdio>
-#include <ctime>
+#include <cstdlib>
+#include <cstring>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 static void print_help()
 {
     DebugFilters def;
     fprintf(stderr, "Usage: Sizer [options] exe_or_pdb_file\n");
-    fprintf(stderr, " -n str  or --name=str           Only include things containing 'str' into report\n");
+    fprintf(stderr, "       Sizer [options] --load-snapshot=file\n");
+    fprintf(stderr, " -n str  or --name=str           Only include things containing 'str' into report; can be repeated,\n");
+    fprintf(stderr, "                                 'glob:pattern' and 're:regex' match wildcards / regular expressions\n");
+    fprintf(stderr, " -x str  or --exclude=str        Leave out things containing 'str'; can be repeated, same forms as --name\n");
     fprintf(stderr, " -a size or --all                Include all symbols, same as --min=0\n");
     fprintf(stderr, " -m size or --min=size           Minimum size for anything to be reported (default varies, see below)\n");
     fprintf(stderr, " -f size or --funcmin=size       Minimum size for functions to be reported (default %.1f)\n", def.minFunction / 1024.0);
@@ -24,10 +36,59 @@ static void print_help()
     fprintf(stderr, " -F size or --filemin=size       Minimum size for file to be reported (default %.1f)\n", def.minFile / 1024.0);
     fprintf(stderr, " -t size or --templatemin=size   Minimum size for template to be reported (default %.1f)\n", def.minTemplate / 1024.0);
     fprintf(stderr, " -T cnt  or --templatecount=cnt  Minimum instantiation count for template to be reported (default %i)\n", def.minTemplateCount);
+    fprintf(stderr, " -k cnt  or --top=cnt            Only report the largest cnt entries of each list (default all)\n");
+    fprintf(stderr, "            --format=fmt         Report format: text (default), jsonl, csv or bin; all but text have exact sizes in bytes\n");
+    fprintf(stderr, " -j cnt  or --threads=cnt        Threads to read PDB and process it with, 0 for all cores (default 1)\n");
+    fprintf(stderr, "            --cache=dir          Keep what was read from PDB files in dir, reuse it while a PDB stays the same\n");
+    fprintf(stderr, "                                 (default: SIZER_CACHE_DIR environment variable, if set)\n");
+    fprintf(stderr, "            --save-snapshot=file Only read the PDB, and save what was read into a snapshot file\n");
+    fprintf(stderr, "            --load-snapshot=file Report from a snapshot file, instead of exe_or_pdb_file\n");
+    fprintf(stderr, "            --stats[=fmt]        Print time, allocations and memory use of each phase to stderr, as text or json\n");
+    fprintf(stderr, "            --mmap=flags         How to map the PDB file, comma separated: populate (read it all in up front),\n");
+    fprintf(stderr, "                                 hugepages (use huge pages where the OS supports that for files)\n");
     fprintf(stderr, " -h or --help                    Print this help\n");
 }
 
-static bool parse_cmdline(int argc,char * const * argv, DebugFilters& outFilters, std::string& outFile)
+static bool parse_format(const char* str, ReportFormat& outFormat)
+{
+    if (strcmp(str, "text") == 0) outFormat = ReportFormat::Text;
+    else if (strcmp(str, "jsonl") == 0) outFormat = ReportFormat::JsonLines;
+    else if (strcmp(str, "csv") == 0) outFormat = ReportFormat::Csv;
+    else if (strcmp(str, "bin") == 0) outFormat = ReportFormat::Binary;
+    else return false;
+    return true;
+}
+
+static bool parse_map_flags(const char* str, int& outFlags)
+{
+    outFlags = 0;
+    while (*str != 0)
+    {
+        const char* end = strchr(str, ',');
+        size_t len = end ? end - str : strlen(str);
+        if (len == 8 && strncmp(str, "populate", len) == 0) outFlags |= MemoryMappedFile::MapPopulate;
+        else if (len == 9 && strncmp(str, "hugepages", len) == 0) outFlags |= MemoryMappedFile::MapHugePages;
+        else if (len != 0) return false;
+        str += end ? len + 1 : len;
+    }
+    return true;
+}
+
+// everything besides report filters
+struct Options
+{
+    std::string file;
+    ReportFormat format = ReportFormat::Text;
+    int threads = 1;
+    std::string cacheDir;
+    std::string saveSnapshot;
+    std::string loadSnapshot;
+    bool stats = false;
+    bool statsJson = false;
+    int mapFlags = 0;
+};
+
+static bool parse_cmdline(int argc,char * const * argv, DebugFilters& outFilters, Options& outOptions)
 {
     parg_state args;
     parg_init(&args);
@@ -35,6 +96,7 @@ static bool parse_cmdline(int argc,char * const * argv, DebugFilters& outFilters
     static const struct parg_option argsTable[] =
     {
         { "name", PARG_REQARG, NULL, 'n' },
+        { "exclude", PARG_REQARG, NULL, 'x' },
         { "all", PARG_NOARG, NULL, 'a' },
         { "min", PARG_REQARG, NULL, 'm' },
         { "funcmin", PARG_REQARG, NULL, 'f' },
@@ -43,17 +105,26 @@ static bool parse_cmdline(int argc,char * const * argv, DebugFilters& outFilters
         { "filemin", PARG_REQARG, NULL, 'F' },
         { "templatemin", PARG_REQARG, NULL, 't' },
         { "templatecount", PARG_REQARG, NULL, 'T' },
+        { "top", PARG_REQARG, NULL, 'k' },
+        { "format", PARG_REQARG, NULL, 'o' },
+        { "threads", PARG_REQARG, NULL, 'j' },
+        { "cache", PARG_REQARG, NULL, 'C' },
+        { "save-snapshot", PARG_REQARG, NULL, 'S' },
+        { "load-snapshot", PARG_REQARG, NULL, 'L' },
+        { "stats", PARG_OPTARG, NULL, 's' },
+        { "mmap", PARG_REQARG, NULL, 'M' },
         { "help", PARG_NOARG, NULL, 'h' },
         { 0, 0, 0, 0 }
     };
 
     int c;
-    while ((c = parg_getopt_long(&args, argc, argv, "an:m:f:d:c:F:t:T:h", argsTable, NULL)) != -1)
+    while ((c = parg_getopt_long(&args, argc, argv, "an:x:m:f:d:c:F:t:T:k:j:h", argsTable, NULL)) != -1)
     {
         switch (c)
         {
-        case 1: outFile = args.optarg; break;
-        case 'n': outFilters.name = args.optarg; break;
+        case 1: outOptions.file = args.optarg; break;
+        case 'n': if (args.optarg[0] != 0) outFilters.names.push_back(args.optarg); break;
+        case 'x': if (args.optarg[0] != 0) outFilters.excludeNames.push_back(args.optarg); break;
         case 'a': outFilters.SetMinSize(0); break;
         case 'm': outFilters.SetMinSize(atof(args.optarg) * 1024); break;
         case 'f': outFilters.minFunction = atof(args.optarg) * 1024; break;
@@ -62,6 +133,38 @@ static bool parse_cmdline(int argc,char * const * argv, DebugFilters& outFilters
         case 'F': outFilters.minFile = atof(args.optarg) * 1024; break;
         case 't': outFilters.minTemplate = atof(args.optarg) * 1024; break;
         case 'T': outFilters.minTemplateCount = atoi(args.optarg); break;
+        case 'k': outFilters.topCount = atoi(args.optarg); break;
+        case 'o':
+            if (!parse_format(args.optarg, outOptions.format))
+            {
+                fprintf(stderr, "Unknown report format '%s'\n", args.optarg);
+                print_help();
+                return false;
+            }
+            break;
+        case 'j': outOptions.threads = atoi(args.optarg); break;
+        case 'C': outOptions.cacheDir = args.optarg; break;
+        case 'S': outOptions.saveSnapshot = args.optarg; break;
+        case 'L': outOptions.loadSnapshot = args.optarg; break;
+        case 's':
+            outOptions.stats = true;
+            if (args.optarg != NULL && strcmp(args.optarg, "json") == 0)
+                outOptions.statsJson = true;
+            else if (args.optarg != NULL && strcmp(args.optarg, "text") != 0)
+            {
+                fprintf(stderr, "Unknown stats format '%s'\n", args.optarg);
+                print_help();
+                return false;
+            }
+            break;
+        case 'M':
+            if (!parse_map_flags(args.optarg, outOptions.mapFlags))
+            {
+                fprintf(stderr, "Unknown mmap flags '%s'\n", args.optarg);
+                print_help();
+                return false;
+            }
+            break;
         case '?':
             fprintf(stderr, "Unknown argument or missing value for '%c'\n", args.optopt);
             // fall through
@@ -72,12 +175,19 @@ static bool parse_cmdline(int argc,char * const * argv, DebugFilters& outFilters
         }
     }
 
-    if (outFile.empty())
+    if (outOptions.file.empty() == outOptions.loadSnapshot.empty())
     {
         print_help();
         return false;
     }
 
+    std::string error;
+    if (!outFilters.nameFilter.Compile(outFilters.names, outFilters.excludeNames, error))
+    {
+        fprintf(stderr, "ERROR: %s\n", error.c_str());
+        return false;
+    }
+
     return true;
 }
 
@@ -87,53 +197,115 @@ static bool ends_with(std::string const& value, std::string const& ending)
     return std::equal(ending.rbegin(), ending.rend(), value.rbegin());
 }
 
+static void print_stats(const Options& options)
+{
+    if (!options.stats)
+        return;
+    if (options.statsJson)
+        StatsWriteJson(stderr);
+    else
+        StatsWriteText(stderr);
+}
+
 int main(int argc, char * const * argv)
 {
     DebugFilters filters;
-    std::string file;
-    if (!parse_cmdline(argc, argv, filters, file))
+    Options options;
+    if (const char* cacheDir = getenv("SIZER_CACHE_DIR"))
+        options.cacheDir = cacheDir;
+    if (!parse_cmdline(argc, argv, filters, options))
     {
         return 0;
     }
+    std::string& file = options.file;
+    const ReportFormat format = options.format;
+    const int threads = options.threads;
+    if (options.stats)
+        StatsEnable();
 
     DebugInfo info;
 
-    clock_t time1 = clock();
+    double time1 = GetWallTime();
 
-    if (ends_with(file, ".exe") || ends_with(file, ".dll") || ends_with(file, ".EXE") || ends_with(file, ".DLL"))
+    if (!options.loadSnapshot.empty())
     {
-        fprintf(stderr, "Finding debug location for %s ...\n", file.c_str());
-        MemoryMappedFile exeFile(file.c_str());
-        if (exeFile.baseAddress == nullptr)
+        fprintf(stderr, "Loading snapshot %s ...\n", options.loadSnapshot.c_str());
+        StatsScope stats("load snapshot");
+        if (!LoadSnapshot(options.loadSnapshot.c_str(), nullptr, info))
         {
-            fprintf(stderr, "ERROR: failed to memory-map file '%s'\n", file.c_str());
+            fprintf(stderr, "ERROR: '%s' is not a snapshot file, or was saved by a different version of Sizer\n", options.loadSnapshot.c_str());
             return 1;
         }
-        std::string pdbPath = PEGetPDBPath(exeFile.baseAddress, exeFile.fileSize);
-        if (!pdbPath.empty())
-            file = pdbPath;
     }
-
-    fprintf(stderr, "Reading debug info for %s ...\n", file.c_str());
-    bool pdbok = ReadDebugInfo(file.c_str(), info);
-    if (!pdbok)
+    else
     {
-        fprintf(stderr, "ERROR reading file via PDB\n");
-        return 1;
+        if (ends_with(file, ".exe") || ends_with(file, ".dll") || ends_with(file, ".EXE") || ends_with(file, ".DLL"))
+        {
+            fprintf(stderr, "Finding debug location for %s ...\n", file.c_str());
+            StatsScope stats("find PDB");
+            MemoryMappedFile exeFile(file.c_str());
+            if (exeFile.baseAddress == nullptr)
+            {
+                fprintf(stderr, "ERROR: failed to memory-map file '%s'\n", file.c_str());
+                return 1;
+            }
+            std::string pdbPath = PEGetPDBPath(exeFile.baseAddress, exeFile.fileSize);
+            if (!pdbPath.empty())
+                file = pdbPath;
+        }
+
+        fprintf(stderr, "Reading debug info for %s ...\n", file.c_str());
+        SnapshotKey key;
+        StatsScope stats("read PDB");
+        bool pdbok = ReadDebugInfo(file.c_str(), threads, options.cacheDir.c_str(), info, &key, options.mapFlags);
+        if (!pdbok)
+        {
+            fprintf(stderr, "ERROR reading file via PDB\n");
+            return 1;
+        }
+        stats.End();
+
+        if (!options.saveSnapshot.empty())
+        {
+            fprintf(stderr, "Saving snapshot %s ...\n", options.saveSnapshot.c_str());
+            stats.Restart("save snapshot");
+            if (!SaveSnapshot(info, key, options.saveSnapshot.c_str()))
+            {
+                fprintf(stderr, "ERROR: failed to write snapshot file '%s'\n", options.saveSnapshot.c_str());
+                return 1;
+            }
+            stats.End();
+            fprintf(stderr, "Done!\n");
+            print_stats(options);
+            return 0;
+        }
     }
+
     fprintf(stderr, "\nProcessing info...\n");
-    info.ComputeDerivedData();
+    {
+        StatsScope stats("derived data");
+        info.ComputeDerivedData(ResolveThreadCount(threads));
+    }
 
     fprintf(stderr, "Generating report...\n");
-    std::string report = info.WriteReport(filters);
-
-    clock_t time2 = clock();
-    float secs = float(time2 - time1) / CLOCKS_PER_SEC;
-
-    fprintf(stderr, "Printing...\n");
-    puts(report.c_str());
-    fprintf(stderr, "Done in %.2f seconds!\n", secs);
+    {
+        StatsScope stats("report");
+#ifdef _WIN32
+        if (format == ReportFormat::Binary)
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        fflush(stdout); // anything printed so far goes before the report
+        ReportWriter out(fileno(stdout));
+        info.WriteReport(filters, format, out);
+        if (format == ReportFormat::Text)
+            out.Write("\n", 1); // report used to be printed with puts, keep its trailing newline
+        StatsScope flushStats("flush");
+        out.Flush();
+    }
 
+    double time2 = GetWallTime();
+    fprintf(stderr, "Done in %.2f seconds!\n", time2 - time1);
+    print_stats(options);
 
     return 0;
 }
@@ -3,6 +3,8 @@
 // Public domain.
 
 #include "mmapfile.h"
+#include <algorithm>
+#include <vector>
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -10,9 +12,53 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+// open files, so that block mapping can find the file descriptor from a base address
+static std::mutex s_OpenFilesMutex;
+static std::vector<const MemoryMappedFile*> s_OpenFiles;
+
+// Each mapped run of blocks is a separate kernel memory mapping; stay well below the
+// default per-process limit (vm.max_map_count is 65530). Callers are expected to copy
+// instead while over it. Run counts of the ranges are kept to give them back on unmapping.
+static const size_t kMaxMappedBlockRuns = 16384;
+static std::atomic<size_t> s_MappedBlockRuns(0);
+static std::mutex s_MappedRangesMutex;
+static std::unordered_map<void*, size_t> s_MappedRangeRuns;
+
+#ifdef MADV_HUGEPAGE
+// Huge pages only back whole, aligned 2MB parts of a mapping: reserve a bit more address
+// space than needed, map the file at an aligned address in it, and give back the rest.
+static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+static void* MapHugePageAligned(int file, size_t size, int mapFlags)
+{
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    const size_t mappedSize = (size + pageSize - 1) & ~(pageSize - 1);
+    const size_t reservedSize = mappedSize + kHugePageSize;
+    char* range = (char*)mmap(nullptr, reservedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (range == MAP_FAILED)
+        return MAP_FAILED;
+    char* aligned = (char*)(((uintptr_t)range + kHugePageSize - 1) & ~uintptr_t(kHugePageSize - 1));
+    if (mmap(aligned, size, PROT_READ, mapFlags | MAP_FIXED, file, 0) == MAP_FAILED)
+    {
+        munmap(range, reservedSize);
+        return MAP_FAILED;
+    }
+    if (aligned != range)
+        munmap(range, aligned - range);
+    if (aligned + mappedSize != range + reservedSize)
+        munmap(aligned + mappedSize, range + reservedSize - (aligned + mappedSize));
+    // only a hint; read-only file mappings get huge pages when the kernel supports that
+    madvise(aligned, size, MADV_HUGEPAGE);
+    return aligned;
+}
+#endif
 #endif
 
-MemoryMappedFile::MemoryMappedFile(const char* path)
+MemoryMappedFile::MemoryMappedFile(const char* path, int flags)
 {
 #ifdef _WIN32
 	void* file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, nullptr);
@@ -41,6 +87,10 @@ MemoryMappedFile::MemoryMappedFile(const char* path)
 	this->mapping = fileMapping;
 	this->baseAddress = baseAddress;
 	this->fileSize = fileSize.QuadPart;
+
+	// no huge pages for views of files on Windows; MapHugePages is ignored
+	if (flags & MapPopulate)
+		Advise(0, this->fileSize, Access::WillNeed);
 #else
     int file = open(path, O_RDONLY);
     if (file == -1)
@@ -51,7 +101,18 @@ MemoryMappedFile::MemoryMappedFile(const char* path)
         close(file);
         return;
     }
-    void* baseAddress = mmap(nullptr, fileSt.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    int mapFlags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (flags & MapPopulate)
+        mapFlags |= MAP_POPULATE;
+#endif
+    void* baseAddress = MAP_FAILED;
+#ifdef MADV_HUGEPAGE
+    if ((flags & MapHugePages) && size_t(fileSt.st_size) >= kHugePageSize)
+        baseAddress = MapHugePageAligned(file, fileSt.st_size, mapFlags);
+#endif
+    if (baseAddress == MAP_FAILED)
+        baseAddress = mmap(nullptr, fileSt.st_size, PROT_READ, mapFlags, file, 0);
     if (baseAddress == MAP_FAILED)
     {
         close(file);
@@ -60,6 +121,13 @@ MemoryMappedFile::MemoryMappedFile(const char* path)
     this->file = file;
     this->baseAddress = baseAddress;
     this->fileSize = fileSt.st_size;
+#ifndef MAP_POPULATE
+    if (flags & MapPopulate)
+        Advise(0, this->fileSize, Access::WillNeed);
+#endif
+
+    std::lock_guard<std::mutex> lock(s_OpenFilesMutex);
+    s_OpenFiles.push_back(this);
 #endif
 }
 
@@ -73,7 +141,173 @@ MemoryMappedFile::~MemoryMappedFile()
 	if (file != INVALID_HANDLE_VALUE)
 		CloseHandle(file);
 #else
+    if (baseAddress == nullptr)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(s_OpenFilesMutex);
+        s_OpenFiles.erase(std::remove(s_OpenFiles.begin(), s_OpenFiles.end(), this), s_OpenFiles.end());
+    }
     munmap(baseAddress, fileSize);
     close(file);
 #endif
 }
+
+void* MemoryMappedFile::MapBlocks(const void* baseAddress, size_t blockSize, const uint32_t* blockIndices, size_t blockCount)
+{
+#ifdef _WIN32
+	// could be done with MapViewOfFile3 and placeholders on Windows 10+; just copy for now
+	(void)baseAddress; (void)blockSize; (void)blockIndices; (void)blockCount;
+	return nullptr;
+#else
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize <= 0 || blockSize == 0 || blockSize % size_t(pageSize) != 0 || blockCount == 0)
+        return nullptr;
+
+    int file = -1;
+    size_t fileSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(s_OpenFilesMutex);
+        for (const MemoryMappedFile* f : s_OpenFiles)
+        {
+            if (f->baseAddress == baseAddress)
+            {
+                file = f->file;
+                fileSize = f->fileSize;
+                break;
+            }
+        }
+    }
+    if (file == -1)
+        return nullptr;
+
+    // runs of consecutive blocks are mapped with one call each
+    size_t runCount = 0;
+    for (size_t i = 0; i < blockCount; ++i)
+    {
+        if (size_t(blockIndices[i]) * blockSize + blockSize > fileSize)
+            return nullptr;
+        if (i == 0 || blockIndices[i] != blockIndices[i - 1] + 1)
+            ++runCount;
+    }
+    if (s_MappedBlockRuns.fetch_add(runCount) + runCount > kMaxMappedBlockRuns)
+    {
+        s_MappedBlockRuns -= runCount;
+        return nullptr;
+    }
+
+    // reserve address space for the whole range, then map file blocks over it
+    const size_t size = blockSize * blockCount;
+    void* range = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (range == MAP_FAILED)
+    {
+        s_MappedBlockRuns -= runCount;
+        return nullptr;
+    }
+    for (size_t i = 0; i < blockCount; )
+    {
+        size_t run = 1;
+        while (i + run < blockCount && blockIndices[i + run] == blockIndices[i] + run)
+            ++run;
+        void* dst = (char*)range + i * blockSize;
+        void* res = mmap(dst, run * blockSize, PROT_READ, MAP_PRIVATE | MAP_FIXED, file, off_t(blockIndices[i]) * off_t(blockSize));
+        if (res == MAP_FAILED)
+        {
+            munmap(range, size);
+            s_MappedBlockRuns -= runCount;
+            return nullptr;
+        }
+        i += run;
+    }
+    std::lock_guard<std::mutex> lock(s_MappedRangesMutex);
+    s_MappedRangeRuns[range] = runCount;
+    return range;
+#endif
+}
+
+void MemoryMappedFile::UnmapBlocks(void* address, size_t size)
+{
+#ifdef _WIN32
+	(void)address; (void)size;
+#else
+    {
+        std::lock_guard<std::mutex> lock(s_MappedRangesMutex);
+        auto it = s_MappedRangeRuns.find(address);
+        if (it != s_MappedRangeRuns.end())
+        {
+            s_MappedBlockRuns -= it->second;
+            s_MappedRangeRuns.erase(it);
+        }
+    }
+    munmap(address, size);
+#endif
+}
+
+#ifdef _WIN32
+// PrefetchVirtualMemory is Windows 8+, look it up so that Sizer still runs on older ones
+struct MemoryRangeEntry
+{
+	void* address;
+	size_t size;
+};
+typedef BOOL (WINAPI *PrefetchVirtualMemoryFunc)(HANDLE process, ULONG_PTR count, MemoryRangeEntry* ranges, ULONG flags);
+#endif
+
+bool MemoryMappedFile::Advise(size_t offset, size_t size, Access access) const
+{
+    if (baseAddress == nullptr || offset >= fileSize || size == 0)
+        return false;
+    if (size > fileSize - offset)
+        size = fileSize - offset;
+#ifdef _WIN32
+	// only prefetching has an equivalent
+	if (access != Access::WillNeed)
+		return false;
+	static const PrefetchVirtualMemoryFunc prefetch = (PrefetchVirtualMemoryFunc)GetProcAddress(GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory");
+	if (prefetch == nullptr)
+		return false;
+	MemoryRangeEntry range = { (char*)baseAddress + offset, size };
+	return prefetch(GetCurrentProcess(), 1, &range, 0) != 0;
+#else
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    const size_t begin = offset & ~(pageSize - 1);
+    const size_t length = offset + size - begin; // madvise rounds the end up itself
+    int advice = MADV_NORMAL;
+    switch (access)
+    {
+    case Access::Normal: advice = MADV_NORMAL; break;
+    case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+    case Access::Random: advice = MADV_RANDOM; break;
+    case Access::WillNeed: advice = MADV_WILLNEED; break;
+    case Access::DontNeed: advice = MADV_DONTNEED; break;
+    }
+    bool ok = madvise((char*)baseAddress + begin, length, advice) == 0;
+#ifdef POSIX_FADV_DONTNEED
+    // madvise only unmaps the pages from this process; drop them from the file cache too
+    if (access == Access::DontNeed)
+        ok = posix_fadvise(file, off_t(begin), off_t(length), POSIX_FADV_DONTNEED) == 0 && ok;
+#endif
+    return ok;
+#endif
+}
+
+// Blocks at most this far apart are hinted as one range: reading a few more blocks is
+// cheaper than more system calls, and than losing the OS read-ahead around them.
+static const size_t kAdviseBlockGap = 16;
+
+bool MemoryMappedFile::AdviseBlocks(size_t blockSize, const uint32_t* blockIndices, size_t blockCount, Access access) const
+{
+    if (blockCount == 0)
+        return false;
+    std::vector<uint32_t> sorted(blockIndices, blockIndices + blockCount);
+    std::sort(sorted.begin(), sorted.end());
+    bool ok = true;
+    for (size_t i = 0; i < blockCount; )
+    {
+        const size_t first = sorted[i];
+        size_t last = first;
+        for (++i; i < blockCount && sorted[i] - last <= kAdviseBlockGap; ++i)
+            last = sorted[i];
+        ok = Advise(first * blockSize, (last - first + 1) * blockSize, access) && ok;
+    }
+    return ok;
+}
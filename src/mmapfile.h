@@ -5,6 +5,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 struct MemoryMappedFile
 {
@@ -17,6 +18,31 @@ struct MemoryMappedFile
 	void* baseAddress = nullptr;
 	size_t fileSize = 0;
 
-	explicit MemoryMappedFile(const char* path);
+	// Flags for opening: MapPopulate reads the whole file in while mapping it, instead of on
+	// first access of each page. MapHugePages asks for huge pages, to have fewer TLB misses
+	// on large files; only where the OS can do that for file mappings (Linux with transparent
+	// huge pages for read-only files), otherwise ignored.
+	enum { MapPopulate = 1, MapHugePages = 2 };
+
+	explicit MemoryMappedFile(const char* path, int flags = 0);
 	~MemoryMappedFile();
+
+	// How a part of the file is going to be accessed: Sequential and Random tune read-ahead,
+	// WillNeed starts reading it in the background, DontNeed lets the OS drop it from memory.
+	enum class Access { Normal, Sequential, Random, WillNeed, DontNeed };
+
+	// Hints the OS about the bytes [offset, offset+size) of the file, rounded out to whole
+	// pages. Returns false if the hint was not given (not supported on this platform etc.);
+	// the file can be read all the same.
+	bool Advise(size_t offset, size_t size, Access access) const;
+	// Same for a list of blocks of blockSize bytes each, in any order (e.g. the blocks of MSF
+	// file streams); nearby blocks are hinted with one call.
+	bool AdviseBlocks(size_t blockSize, const uint32_t* blockIndices, size_t blockCount, Access access) const;
+
+	// Maps blocks of an open mapped file (identified by its baseAddress) back to back into one
+	// contiguous address range, without copying: block i of the result is file block
+	// blockIndices[i]. Block size must be a multiple of the page size. Returns nullptr when that
+	// is not possible (or not supported on this platform); release with UnmapBlocks.
+	static void* MapBlocks(const void* baseAddress, size_t blockSize, const uint32_t* blockIndices, size_t blockCount);
+	static void UnmapBlocks(void* address, size_t size);
 };
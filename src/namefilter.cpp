@@ -0,0 +1,174 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#include "namefilter.hpp"
+#include <string.h>
+
+static const char kGlobPrefix[] = "glob:";
+static const char kRegexPrefix[] = "re:";
+
+static bool StartsWith(const std::string& str, const char* prefix, size_t prefixLength)
+{
+    return str.compare(0, prefixLength, prefix) == 0;
+}
+
+bool NameFilter::Compile(const std::vector<std::string>& includes, const std::vector<std::string>& excludes, std::string& outError)
+{
+    for (const std::string& pattern : includes)
+        if (!AddPattern(pattern, kMatchInclude, outError))
+            return false;
+    for (const std::string& pattern : excludes)
+        if (!AddPattern(pattern, kMatchExclude, outError))
+            return false;
+    m_HasIncludes = !includes.empty();
+    m_HasExcludes = !excludes.empty();
+    if (m_Literals.size() > 1)
+        BuildAutomaton();
+    return true;
+}
+
+bool NameFilter::AddPattern(const std::string& pattern, uint32_t flag, std::string& outError)
+{
+    m_AllFlags |= flag;
+    if (StartsWith(pattern, kGlobPrefix, sizeof(kGlobPrefix) - 1))
+    {
+        m_Globs.emplace_back(pattern.substr(sizeof(kGlobPrefix) - 1), flag);
+    }
+    else if (StartsWith(pattern, kRegexPrefix, sizeof(kRegexPrefix) - 1))
+    {
+        try
+        {
+            m_Regexes.emplace_back(std::regex(pattern.substr(sizeof(kRegexPrefix) - 1), std::regex::ECMAScript | std::regex::optimize), flag);
+        }
+        catch (const std::regex_error& e)
+        {
+            outError = "invalid regular expression '" + pattern + "': " + e.what();
+            return false;
+        }
+    }
+    else
+    {
+        m_Literals.emplace_back(pattern, flag);
+    }
+    return true;
+}
+
+void NameFilter::BuildAutomaton()
+{
+    // trie of all the substrings first; ~0u marks missing edges
+    m_Next.assign(256, ~0u);
+    m_StateFlags.assign(1, 0);
+    for (const auto& lit : m_Literals)
+    {
+        uint32_t state = 0;
+        for (char ch : lit.first)
+        {
+            uint32_t& next = m_Next[state * 256 + uint8_t(ch)];
+            if (next == ~0u)
+            {
+                next = uint32_t(m_StateFlags.size());
+                m_StateFlags.push_back(0);
+                m_Next.resize(m_Next.size() + 256, ~0u);
+            }
+            state = m_Next[state * 256 + uint8_t(ch)];
+        }
+        m_StateFlags[state] |= uint8_t(lit.second);
+    }
+
+    // Breadth first, turn it into a full transition table: missing edges go where the
+    // longest proper suffix of the state would go, and states inherit flags of that suffix.
+    std::vector<uint32_t> fail(m_StateFlags.size(), 0);
+    std::vector<uint32_t> queue;
+    for (int c = 0; c < 256; ++c)
+    {
+        uint32_t& next = m_Next[c];
+        if (next == ~0u)
+            next = 0;
+        else
+            queue.push_back(next);
+    }
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        const uint32_t state = queue[i];
+        m_StateFlags[state] |= m_StateFlags[fail[state]];
+        for (int c = 0; c < 256; ++c)
+        {
+            uint32_t& next = m_Next[state * 256 + c];
+            const uint32_t failNext = m_Next[fail[state] * 256 + c];
+            if (next == ~0u)
+            {
+                next = failNext;
+            }
+            else
+            {
+                fail[next] = failNext;
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+uint32_t NameFilter::Match(const char* str, size_t length) const
+{
+    uint32_t flags = 0;
+    if (m_Literals.size() == 1)
+    {
+        if (strstr(str, m_Literals[0].first.c_str()) != nullptr)
+            flags |= m_Literals[0].second;
+    }
+    else if (!m_Literals.empty())
+    {
+        uint32_t state = 0;
+        flags |= m_StateFlags[0];
+        for (size_t i = 0; i < length && flags != m_AllFlags; ++i)
+        {
+            state = m_Next[state * 256 + uint8_t(str[i])];
+            flags |= m_StateFlags[state];
+        }
+    }
+
+    for (const auto& glob : m_Globs)
+    {
+        if ((flags & glob.second) == 0 && GlobMatch(glob.first.c_str(), str, str + length))
+            flags |= glob.second;
+    }
+    for (const auto& re : m_Regexes)
+    {
+        if ((flags & re.second) == 0 && std::regex_search(str, str + length, re.first))
+            flags |= re.second;
+    }
+    return flags;
+}
+
+bool NameFilter::GlobMatch(const char* pattern, const char* str, const char* strEnd)
+{
+    // on a mismatch, retry from the last '*', letting it eat one more character
+    const char* starPattern = nullptr;
+    const char* starStr = nullptr;
+    while (str != strEnd)
+    {
+        if (*pattern == '*')
+        {
+            starPattern = ++pattern;
+            starStr = str;
+        }
+        else if (*pattern != 0 && (*pattern == '?' || *pattern == *str))
+        {
+            ++pattern;
+            ++str;
+        }
+        else if (starPattern != nullptr)
+        {
+            pattern = starPattern;
+            str = ++starStr;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (*pattern == '*')
+        ++pattern;
+    return *pattern == 0;
+}
@@ -0,0 +1,61 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Matches names against a set of include and exclude patterns, compiled once up front.
+// Patterns are plain substrings, unless prefixed with "glob:" (shell-style wildcards '*' and
+// '?', matching the whole name) or "re:" (ECMAScript regular expression, matching anywhere).
+//
+// All plain substrings are searched for together in one pass over the name (Aho-Corasick
+// automaton), so the cost does not grow with the number of patterns. Names passed to Match
+// have to be null terminated.
+class NameFilter
+{
+public:
+    enum
+    {
+        kMatchInclude = 1 << 0, // name matches one of the include patterns
+        kMatchExclude = 1 << 1, // name matches one of the exclude patterns
+    };
+
+    // Returns false (and an error message) if some pattern could not be compiled.
+    bool Compile(const std::vector<std::string>& includes, const std::vector<std::string>& excludes, std::string& outError);
+
+    bool IsActive() const { return m_HasIncludes || m_HasExcludes; }
+
+    // kMatch* flags of patterns that the name matches.
+    uint32_t Match(const char* str, size_t length) const;
+    // Whether something with the given (or-ed together) match flags should be reported.
+    bool Accepts(uint32_t flags) const
+    {
+        return (!m_HasIncludes || (flags & kMatchInclude) != 0) && (flags & kMatchExclude) == 0;
+    }
+
+private:
+    bool AddPattern(const std::string& pattern, uint32_t flag, std::string& outError);
+    void BuildAutomaton();
+    static bool GlobMatch(const char* pattern, const char* str, const char* strEnd);
+
+private:
+    // plain substrings; a single one is just searched for with strstr
+    std::vector<std::pair<std::string, uint32_t>> m_Literals;
+    // automaton over all the substrings: 256 next states per state, and flags of the
+    // patterns that end in each state
+    std::vector<uint32_t> m_Next;
+    std::vector<uint8_t> m_StateFlags;
+
+    std::vector<std::pair<std::string, uint32_t>> m_Globs;
+    std::vector<std::pair<std::regex, uint32_t>> m_Regexes;
+
+    uint32_t m_AllFlags = 0;
+    bool m_HasIncludes = false;
+    bool m_HasExcludes = false;
+};
@@ -0,0 +1,65 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Turns a requested thread count into an actual one; zero or negative means
+// "use all hardware threads".
+inline int ResolveThreadCount(int requested)
+{
+    if (requested > 0)
+        return requested;
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? int(hw) : 1;
+}
+
+// Calls func(index, threadIndex) for each index in [0, count), spread over up to
+// threadCount threads. The calling thread participates as thread 0, so with one
+// thread everything runs inline. Work is handed out in batches from a shared
+// counter: threads that finish early keep taking batches nobody has started yet,
+// which balances uneven items (e.g. module sizes) without any per-thread queues.
+template <typename F>
+void ParallelFor(int threadCount, size_t count, size_t batchSize, F&& func)
+{
+    if (batchSize == 0)
+        batchSize = 1;
+    size_t batchCount = (count + batchSize - 1) / batchSize;
+    if (threadCount > int(batchCount))
+        threadCount = int(batchCount);
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(i, 0);
+        return;
+    }
+
+    std::atomic<size_t> nextBatch(0);
+    auto worker = [&](int threadIndex)
+    {
+        while (true)
+        {
+            size_t batch = nextBatch.fetch_add(1, std::memory_order_relaxed);
+            if (batch >= batchCount)
+                break;
+            size_t end = (batch + 1) * batchSize;
+            if (end > count)
+                end = count;
+            for (size_t i = batch * batchSize; i < end; ++i)
+                func(i, threadIndex);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (int t = 1; t < threadCount; ++t)
+        threads.emplace_back(worker, t);
+    worker(0);
+    for (auto& t : threads)
+        t.join();
+}
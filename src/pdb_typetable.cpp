@@ -3,10 +3,15 @@
 // Public domain.
 
 #include "pdb_typetable.hpp"
+#include "raw_pdb/PDB_RawFile.h"
+#include <algorithm>
+
+static const uint32_t kUnknownTypeSize = ~0u;
 
 TypeTable::TypeTable(const PDB::TPIStream& tpiStream) PDB_NO_EXCEPT
 	: typeIndexBegin(tpiStream.GetFirstTypeIndex()), typeIndexEnd(tpiStream.GetLastTypeIndex()),
-	m_recordCount(tpiStream.GetTypeRecordCount())
+	m_recordCount(tpiStream.GetTypeRecordCount()),
+	m_lazyStream(nullptr), m_offsets(nullptr)
 {
 	// Create coalesced stream from TPI stream, so the records can be referenced directly using pointers.
 	const PDB::DirectMSFStream& directStream = tpiStream.GetDirectMSFStream();
@@ -17,6 +22,9 @@ TypeTable::TypeTable(const PDB::TPIStream& tpiStream) PDB_NO_EXCEPT
 	// similarly, because types are variable-length records, there are no direct offsets to access individual types.
 	// we therefore walk the TPI stream once, and store pointers to the records for trivial O(1) array lookup by index later.	
 	m_records = new const PDB::CodeView::TPI::Record*[m_recordCount];
+	m_sizes = new uint32_t[m_recordCount];
+	for (size_t i = 0; i < m_recordCount; ++i)
+		m_sizes[i] = kUnknownTypeSize;
 
 	// parse the CodeView records
 	uint32_t typeIndex = 0u;
@@ -34,9 +42,114 @@ TypeTable::TypeTable(const PDB::TPIStream& tpiStream) PDB_NO_EXCEPT
 		});
 }
 
+TypeTable::TypeTable(const PDB::RawFile& file, const PDB::TPIStream& tpiStream) PDB_NO_EXCEPT
+	: typeIndexBegin(tpiStream.GetFirstTypeIndex()), typeIndexEnd(tpiStream.GetLastTypeIndex()),
+	m_recordCount(tpiStream.GetTypeRecordCount()),
+	m_lazyStream(&tpiStream)
+{
+	m_records = new const PDB::CodeView::TPI::Record*[m_recordCount]();
+	m_offsets = new uint32_t[m_recordCount]();
+	m_sizes = new uint32_t[m_recordCount];
+	for (size_t i = 0; i < m_recordCount; ++i)
+		m_sizes[i] = kUnknownTypeSize;
+
+	// The TPI hash stream has "type index -> offset" pairs for every few kilobytes of type
+	// records; offsets there are relative to the end of the TPI stream header.
+	const PDB::TPI::StreamHeader& header = tpiStream.GetHeader();
+	if (header.hashStreamIndex == 0xFFFF || header.hashStreamIndex >= file.GetStreamCount())
+		return;
+	const PDB::DirectMSFStream hashStream = file.CreateMSFStream<PDB::DirectMSFStream>(header.hashStreamIndex);
+	if (header.indexOffsetBufferOffset < 0 || uint64_t(header.indexOffsetBufferOffset) + header.indexOffsetBufferLength > hashStream.GetSize())
+		return;
+
+	const uint32_t pairCount = header.indexOffsetBufferLength / sizeof(IndexOffset);
+	m_indexOffsets.resize(pairCount);
+	if (pairCount != 0)
+		hashStream.ReadAtOffset(m_indexOffsets.data(), pairCount * sizeof(IndexOffset), size_t(header.indexOffsetBufferOffset));
+	const uint32_t streamSize = tpiStream.GetDirectMSFStream().GetSize();
+	uint32_t prevIndex = 0;
+	for (IndexOffset& io : m_indexOffsets)
+	{
+		io.offset += header.headerSize;
+		if (io.typeIndex < typeIndexBegin || io.typeIndex >= typeIndexEnd || io.typeIndex < prevIndex || io.offset >= streamSize)
+		{
+			// not something we can trust, just walk from the start
+			m_indexOffsets.clear();
+			break;
+		}
+		prevIndex = io.typeIndex;
+	}
+}
+
 TypeTable::~TypeTable() PDB_NO_EXCEPT
 {
 	delete[] m_records;
+	delete[] m_sizes;
+	delete[] m_offsets;
+}
+
+const PDB::CodeView::TPI::Record* TypeTable::LoadTypeRecord(uint32_t typeIndex) const PDB_NO_EXCEPT
+{
+	const PDB::DirectMSFStream& stream = m_lazyStream->GetDirectMSFStream();
+	const uint32_t index = typeIndex - typeIndexBegin;
+
+	// Start from the closest type before this one with a known offset: either one from the
+	// hash stream index/offset table, or one seen during an earlier walk.
+	uint32_t startIndex = 0;
+	uint32_t offset = m_lazyStream->GetHeader().headerSize;
+	auto it = std::upper_bound(m_indexOffsets.begin(), m_indexOffsets.end(), typeIndex, [](uint32_t ti, const IndexOffset& io) { return ti < io.typeIndex; });
+	if (it != m_indexOffsets.begin())
+	{
+		--it;
+		startIndex = it->typeIndex - typeIndexBegin;
+		offset = it->offset;
+	}
+	for (uint32_t i = index; i > startIndex; --i)
+	{
+		if (m_offsets[i] != 0)
+		{
+			startIndex = i;
+			offset = m_offsets[i];
+			break;
+		}
+	}
+
+	// walk record headers up to the wanted one, remembering offsets along the way
+	const uint32_t streamSize = stream.GetSize();
+	for (uint32_t i = startIndex; ; ++i)
+	{
+		if (offset + sizeof(PDB::CodeView::TPI::RecordHeader) > streamSize)
+			return nullptr;
+		m_offsets[i] = offset;
+		if (i == index)
+			break;
+		const PDB::CodeView::TPI::RecordHeader header = m_lazyStream->ReadTypeRecordHeader(offset);
+		offset += uint32_t(sizeof(PDB::CodeView::TPI::RecordHeader) + header.size - sizeof(uint16_t));
+	}
+
+	// record size does not include the size field itself
+	const PDB::CodeView::TPI::RecordHeader header = m_lazyStream->ReadTypeRecordHeader(offset);
+	const uint32_t recordSize = uint32_t(header.size + sizeof(uint16_t));
+	if (offset + recordSize > streamSize)
+		return nullptr;
+	uint8_t* data = new uint8_t[recordSize];
+	stream.ReadAtOffset(data, recordSize, offset);
+	m_loadedRecords.emplace_back(data);
+
+	const PDB::CodeView::TPI::Record* record = reinterpret_cast<const PDB::CodeView::TPI::Record*>(data);
+	m_records[index] = record;
+	return record;
+}
+
+uint32_t TypeTable::GetTypeSize(uint32_t typeIndex) PDB_NO_EXCEPT
+{
+	if (typeIndex < typeIndexBegin || typeIndex >= typeIndexEnd)
+		return uint32_t(PDBGetTypeSize(*this, typeIndex));
+
+	uint32_t& size = m_sizes[typeIndex - typeIndexBegin];
+	if (size == kUnknownTypeSize)
+		size = uint32_t(PDBGetTypeSize(*this, typeIndex));
+	return size;
 }
 
 static size_t ExtractLength(const char* ptr)
@@ -68,8 +181,39 @@ static size_t ExtractLength(const char* ptr)
 	return 0;
 }
 
+// LF_MODIFIER, LF_BITFIELD and LF_ENUM just refer to another type; follows those to the type
+// that has a size. T_NOTYPE if there are too many of them (a malformed PDB with a cycle).
+static uint32_t ResolveTypeChain(const TypeTable& typeTable, uint32_t typeIndex)
+{
+	for (int hops = 0; hops < 64; ++hops)
+	{
+		if (typeIndex < typeTable.GetFirstTypeIndex())
+			return typeIndex;
+		auto typeRecord = typeTable.GetTypeRecord(typeIndex);
+		if (!typeRecord)
+			return typeIndex;
+		switch (typeRecord->header.kind)
+		{
+		case PDB::CodeView::TPI::TypeRecordKind::LF_MODIFIER:
+			typeIndex = typeRecord->data.LF_MODIFIER.type;
+			break;
+		case PDB::CodeView::TPI::TypeRecordKind::LF_BITFIELD:
+			typeIndex = typeRecord->data.LF_BITFIELD.type;
+			break;
+		case PDB::CodeView::TPI::TypeRecordKind::LF_ENUM:
+			typeIndex = typeRecord->data.LF_ENUM.utype;
+			break;
+		default:
+			return typeIndex;
+		}
+	}
+	return uint32_t(PDB::CodeView::TPI::TypeIndexKind::T_NOTYPE);
+}
+
 size_t PDBGetTypeSize(const TypeTable& typeTable, uint32_t typeIndex)
 {
+	typeIndex = ResolveTypeChain(typeTable, typeIndex);
+
 	// basic types
 	auto typeIndexBegin = typeTable.GetFirstTypeIndex();
 	if (typeIndex < typeIndexBegin)
@@ -286,16 +430,12 @@ size_t PDBGetTypeSize(const TypeTable& typeTable, uint32_t typeIndex)
 
 	switch (typeRecord->header.kind)
 	{
-	case PDB::CodeView::TPI::TypeRecordKind::LF_MODIFIER:
-		return PDBGetTypeSize(typeTable, typeRecord->data.LF_MODIFIER.type);
 	case PDB::CodeView::TPI::TypeRecordKind::LF_POINTER:
 		if (typeRecord->data.LF_POINTER.attr.ptrtype == 0x0c) // CV_PTR_64
 			return 8;
 		return 4;
 	case PDB::CodeView::TPI::TypeRecordKind::LF_PROCEDURE:
 		return 0;
-	case PDB::CodeView::TPI::TypeRecordKind::LF_BITFIELD:
-		return PDBGetTypeSize(typeTable, typeRecord->data.LF_BITFIELD.type);
 	case PDB::CodeView::TPI::TypeRecordKind::LF_ARRAY:
 		return ExtractLength((const char*)typeRecord->data.LF_ARRAY.data);
 	case PDB::CodeView::TPI::TypeRecordKind::LF_CLASS:
@@ -303,8 +443,6 @@ size_t PDBGetTypeSize(const TypeTable& typeTable, uint32_t typeIndex)
 		return ExtractLength((const char*)typeRecord->data.LF_CLASS.data);
 	case  PDB::CodeView::TPI::TypeRecordKind::LF_UNION:
 		return ExtractLength((const char*)typeRecord->data.LF_UNION.data);
-	case PDB::CodeView::TPI::TypeRecordKind::LF_ENUM:
-		return PDBGetTypeSize(typeTable, typeRecord->data.LF_ENUM.utype);
 	default:
 		break;
 	}
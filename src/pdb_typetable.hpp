@@ -5,13 +5,26 @@
 #pragma once
 
 #include <stddef.h>
+#include <memory>
+#include <vector>
 #include "raw_pdb/PDB_TPIStream.h"
 #include "raw_pdb/PDB_CoalescedMSFStream.h"
 
+namespace PDB
+{
+	class RawFile;
+}
+
 class TypeTable
 {
 public:
+	// Eager mode: coalesces the whole TPI stream up front and finds all the type records.
+	// Best when many of the types are going to be looked at.
 	explicit TypeTable(const PDB::TPIStream& tpiStream) PDB_NO_EXCEPT;
+	// Lazy mode: type records are read on demand from the TPI stream, which has to outlive
+	// the table. The type index / offset table from the TPI hash stream (when present) is used
+	// to jump close to a type, so only MSF blocks around the queried types are touched.
+	TypeTable(const PDB::RawFile& file, const PDB::TPIStream& tpiStream) PDB_NO_EXCEPT;
 	~TypeTable() PDB_NO_EXCEPT;
 
 	// Returns the index of the first type, which is not necessarily zero.
@@ -28,28 +41,50 @@ public:
 
 	PDB_NO_DISCARD inline const PDB::CodeView::TPI::Record* GetTypeRecord(uint32_t typeIndex) const PDB_NO_EXCEPT
 	{
-		if (typeIndex < typeIndexBegin || typeIndex > typeIndexEnd)
+		if (typeIndex < typeIndexBegin || typeIndex >= typeIndexEnd)
 			return nullptr;
 
-		return m_records[typeIndex - typeIndexBegin];
+		const PDB::CodeView::TPI::Record* record = m_records[typeIndex - typeIndexBegin];
+		if (record == nullptr && m_lazyStream != nullptr)
+			record = LoadTypeRecord(typeIndex);
+		return record;
 	}
 
-	// Returns a view of all type records.
+	// Returns a view of all type records; in lazy mode only the ones loaded so far are non-null.
 	// Records identified by a type index can be accessed via "allRecords[typeIndex - firstTypeIndex]".
 	PDB_NO_DISCARD inline PDB::ArrayView<const PDB::CodeView::TPI::Record*> GetTypeRecords(void) const PDB_NO_EXCEPT
 	{
 		return PDB::ArrayView<const PDB::CodeView::TPI::Record*>(m_records, m_recordCount);
 	}
 
+	// Returns size of a type, like PDBGetTypeSize. Sizes of non-basic types are cached in a
+	// dense table indexed by "typeIndex - firstTypeIndex", filled on first use. Not thread safe.
+	PDB_NO_DISCARD uint32_t GetTypeSize(uint32_t typeIndex) PDB_NO_EXCEPT;
+
 private:
+	const PDB::CodeView::TPI::Record* LoadTypeRecord(uint32_t typeIndex) const PDB_NO_EXCEPT;
+
 	uint32_t typeIndexBegin;
 	uint32_t typeIndexEnd;
 
 	size_t m_recordCount;
-	const PDB::CodeView::TPI::Record** m_records;
+	mutable const PDB::CodeView::TPI::Record** m_records;
+	uint32_t* m_sizes;
 
+	// eager mode
 	PDB::CoalescedMSFStream m_stream;
 
+	// lazy mode
+	struct IndexOffset
+	{
+		uint32_t typeIndex;
+		uint32_t offset;
+	};
+	const PDB::TPIStream* m_lazyStream;
+	std::vector<IndexOffset> m_indexOffsets; // from TPI hash stream, offsets relative to TPI stream start
+	mutable uint32_t* m_offsets; // TPI stream offset of each record, zero when not known yet
+	mutable std::vector<std::unique_ptr<uint8_t[]>> m_loadedRecords;
+
 	PDB_DISABLE_COPY(TypeTable);
 };
 
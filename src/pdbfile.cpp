@@ -12,25 +12,33 @@
 #include "raw_pdb/PDB_RawFile.h"
 #include "raw_pdb/PDB_DBIStream.h"
 #include "raw_pdb/PDB_TPIStream.h"
+#include "raw_pdb/PDB_Util.h"
 #include "pdb_typetable.hpp"
+#include "parallel.hpp"
+#include "radixsort.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+#include "stringpool.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <set>
-#include <unordered_map>
-
-struct SectionContrib
-{
-    uint32_t Section;
-    uint32_t Offset;
-    uint32_t Length;
-    uint32_t Compiland;
-    SectionType Type;
-    int32_t ObjFileIndex;
-};
+#include <string>
+#include <errno.h>
+#include <string.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
 
 struct PDBSymbol
 {
-    std::string name;
+    const char* name = nullptr;
+    const SectionContrib* contrib = nullptr; // resolved once symbols are sorted
     uint32_t rva = 0;
     uint32_t length = 0;
     uint32_t section = 0;
@@ -38,8 +46,21 @@ struct PDBSymbol
     uint32_t typeIndex = 0;
 };
 
+// Symbol names are mostly not copied; they point straight into the memory-mapped PDB file,
+// or into coalesced stream data for records that straddle MSF blocks. This keeps all of
+// that alive for as long as DebugInfo holds the symbols. Module symbol streams that had to
+// be copied are freed once read, their names are copied into the names arena instead.
+struct PDBNameStorage
+{
+    std::unique_ptr<MemoryMappedFile> file;
+    PDB::CoalescedMSFStream symbolRecordStream;
+    std::vector<PDB::ModuleSymbolStream> moduleSymbolStreams;
+    std::mutex namesMutex;
+    StringPool names;
+};
+
 
-static const SectionContrib* ContribFromSectionOffset(const SectionContrib* contribs, size_t contribsCount, uint32_t sec, uint32_t offs)
+const SectionContrib* ContribFromSectionOffset(const SectionContrib* contribs, size_t contribsCount, uint32_t sec, uint32_t offs)
 {
     int32_t l, r, x;
 
@@ -65,12 +86,34 @@ static const SectionContrib* ContribFromSectionOffset(const SectionContrib* cont
     return 0;
 }
 
-typedef std::unordered_map<uint32_t, PDBSymbol> RVAToSymbolMap;
 
+// Finds the contribution of each symbol with one merge walk over symbols and contributions,
+// both sorted by section & offset. Symbols are sorted by RVA, which normally is the same
+// order; any symbol that goes backwards falls back to a binary search.
+static void ResolveSymbolContribs(const std::vector<SectionContrib>& contribs, std::vector<PDBSymbol>& symbols)
+{
+    const SectionContrib* cur = contribs.data();
+    const SectionContrib* end = cur + contribs.size();
+    uint32_t prevSection = 0, prevOffset = 0;
+    for (PDBSymbol& sym : symbols)
+    {
+        if (sym.section < prevSection || (sym.section == prevSection && sym.offset < prevOffset))
+        {
+            sym.contrib = ContribFromSectionOffset(contribs.data(), contribs.size(), sym.section, sym.offset);
+            continue;
+        }
+        prevSection = sym.section;
+        prevOffset = sym.offset;
+
+        while (cur != end && (cur->Section < sym.section || (cur->Section == sym.section && sym.offset >= cur->Offset + cur->Length)))
+            ++cur;
+        if (cur != end && cur->Section == sym.section && sym.offset >= cur->Offset)
+            sym.contrib = cur;
+    }
+}
 
-static void AddSymbol(const SectionContrib* contribs, size_t contribsCount, uint32_t section, uint32_t offset, const std::string& name, uint32_t length, DebugInfo& to)
+static void AddSymbol(const SectionContrib* contrib, const char* name, uint32_t length, DebugInfo& to)
 {
-    const SectionContrib* contrib = ContribFromSectionOffset(contribs, contribsCount, section, offset);
     int32_t objFileIndex = 0;
     SectionType sectionType = SectionType::Unknown;
     if (contrib)
@@ -82,18 +125,18 @@ static void AddSymbol(const SectionContrib* contribs, size_t contribsCount, uint
     }
 
     SymbolInfo outSym;
-    outSym.name = name.empty() ? "<noname>" : name;
+    outSym.nameId = to.InternSymbolName(name[0] == 0 ? "<noname>" : name);
     outSym.objectFileIndex = objFileIndex;
     outSym.size = length;
     outSym.sectionType = sectionType;
     outSym.namespaceIndex = to.GetNameSpaceIndex(name);
 
-    to.m_Symbols.emplace_back(outSym);
+    to.AddSymbol(outSym);
 }
 
-static void ProcessSymbol(const PDB::ImageSectionStream& imageSectionStream, const PDB::CodeView::DBI::Record* record, RVAToSymbolMap& toMap)
+// Fills symbol from a record; returns false if the record should be ignored.
+static bool ProcessSymbol(const PDB::ImageSectionStream& imageSectionStream, const PDB::CodeView::DBI::Record* record, PDBSymbol& symbol)
 {
-    PDBSymbol symbol;
     if (record->header.kind == PDB::CodeView::DBI::SymbolRecordKind::S_PUB32)
     {
         if (PDB_AS_UNDERLYING(record->data.S_PUB32.flags) & PDB_AS_UNDERLYING(PDB::CodeView::DBI::PublicSymbolFlags::Function))
@@ -135,7 +178,7 @@ static void ProcessSymbol(const PDB::ImageSectionStream& imageSectionStream, con
     {
         symbol.name = record->data.S_LDATA32.name;
         // Often there are LDATA32 symbols without a name that are same size as function entries? Skip those.
-        if (!symbol.name.empty())
+        if (symbol.name[0] != 0)
         {
             symbol.section = record->data.S_LDATA32.section;
             symbol.offset = record->data.S_LDATA32.offset;
@@ -167,26 +210,134 @@ static void ProcessSymbol(const PDB::ImageSectionStream& imageSectionStream, con
     if (symbol.rva == 0u)
     {
         // certain symbols (e.g. control-flow guard symbols) don't have a valid RVA, ignore those
-        return;
+        return false;
     }
+    return true;
+}
 
-    toMap.insert({ symbol.rva, symbol });
+static void ProcessSymbol(const PDB::ImageSectionStream& imageSectionStream, const PDB::CodeView::DBI::Record* record, std::vector<PDBSymbol>& to)
+{
+    PDBSymbol symbol;
+    if (ProcessSymbol(imageSectionStream, record, symbol))
+        to.emplace_back(std::move(symbol));
 }
 
+// Runs process(itemIndex, output) for items [0, itemCount) on several threads, each
+// thread appending symbols into its own buffer. Then appends all that to symbols in item
+// order, i.e. exactly what a serial loop over the items would have produced.
+template <typename F>
+static void CollectSymbols(int threadCount, size_t itemCount, size_t batchSize, std::vector<PDBSymbol>& symbols, F&& process)
+{
+    struct ItemRange
+    {
+        int thread;
+        size_t begin, end;
+    };
+    std::vector<ItemRange> itemRanges(itemCount, ItemRange{ 0, 0, 0 });
+    std::vector<std::vector<PDBSymbol>> threadSymbols(threadCount);
+    ParallelFor(threadCount, itemCount, batchSize, [&](size_t itemIndex, int threadIndex)
+    {
+        std::vector<PDBSymbol>& dst = threadSymbols[threadIndex];
+        ItemRange& range = itemRanges[itemIndex];
+        range.thread = threadIndex;
+        range.begin = dst.size();
+        process(itemIndex, dst);
+        range.end = dst.size();
+    });
+
+    size_t totalCount = symbols.size();
+    for (const auto& syms : threadSymbols)
+        totalCount += syms.size();
+    symbols.reserve(totalCount);
+    for (const ItemRange& range : itemRanges)
+    {
+        std::vector<PDBSymbol>& src = threadSymbols[range.thread];
+        symbols.insert(symbols.end(), std::make_move_iterator(src.begin() + range.begin), std::make_move_iterator(src.begin() + range.end));
+    }
+}
 
-static void ReadEverything(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, DebugInfo &to)
+// Global & public symbol hash records are processed in chunks of this many.
+static const size_t kHashRecordChunkSize = 4096;
+
+// Sorts symbols by RVA and removes duplicates, keeping the first symbol that was
+// added at any given RVA. The radix sort is stable, so "first" is append order.
+static void SortAndDedupeSymbols(std::vector<PDBSymbol>& symbols)
+{
+    RadixSort32(symbols, [](const PDBSymbol& sym) { return sym.rva; });
+    size_t count = 0;
+    for (size_t i = 0, n = symbols.size(); i < n; ++i)
+    {
+        if (count != 0 && symbols[count - 1].rva == symbols[i].rva)
+            continue;
+        if (count != i)
+            symbols[count] = std::move(symbols[i]);
+        ++count;
+    }
+    symbols.resize(count);
+}
+
+
+// Streams at fixed indices in every PDB.
+static const uint32_t kInfoStreamIndex = 1;
+static const uint32_t kTPIStreamIndex = 2;
+static const uint32_t kDBIStreamIndex = 3;
+
+// Size of nil streams in the stream directory; they have no blocks.
+static const uint32_t kNilStreamSize = 0xFFFFFFFFu;
+
+// Adds the blocks of a stream (up to maxSize bytes of it) to a list of blocks to prefetch.
+static void AddStreamBlocks(const PDB::RawFile& rawPdbFile, uint32_t streamIndex, uint32_t maxSize, std::vector<uint32_t>& blocks)
+{
+    if (streamIndex >= rawPdbFile.GetStreamCount())
+        return;
+    const uint32_t streamSize = rawPdbFile.GetStreamSize(streamIndex);
+    if (streamSize == 0 || streamSize == kNilStreamSize)
+        return;
+    const uint32_t size = std::min(streamSize, maxSize);
+    const uint32_t* streamBlocks = rawPdbFile.GetStreamBlocks(streamIndex);
+    blocks.insert(blocks.end(), streamBlocks, streamBlocks + PDB::ConvertSizeToBlockCount(size, rawPdbFile.GetBlockSize()));
+}
+
+// Has the OS start reading blocks in before they are parsed. Blocks of a stream can be anywhere
+// in the file; page faults on them would read them in one by one, with read-ahead of whatever
+// happens to be next to them.
+static void PrefetchBlocks(const MemoryMappedFile& file, const PDB::RawFile& rawPdbFile, const std::vector<uint32_t>& blocks)
+{
+    file.AdviseBlocks(rawPdbFile.GetBlockSize(), blocks.data(), blocks.size(), MemoryMappedFile::Access::WillNeed);
+}
+
+static void PrefetchStream(const MemoryMappedFile& file, const PDB::RawFile& rawPdbFile, uint32_t streamIndex)
+{
+    std::vector<uint32_t> blocks;
+    AddStreamBlocks(rawPdbFile, streamIndex, UINT32_MAX, blocks);
+    PrefetchBlocks(file, rawPdbFile, blocks);
+}
+
+static void ReadEverything(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream, int threadCount, PDBNameStorage& nameStorage, DebugInfo &to)
 {
     fprintf(stderr, "[      ]");
 
     // create the PDB streams
+    StatsScope stats("contributions");
+    const MemoryMappedFile& pdbFile = *nameStorage.file;
+    const PDB::DBI::StreamHeader& dbiHeader = dbiStream.GetHeader();
+    PrefetchStream(pdbFile, rawPdbFile, dbiHeader.symbolRecordStreamIndex);
     const PDB::ImageSectionStream imageSectionStream = dbiStream.CreateImageSectionStream(rawPdbFile);
     const PDB::ModuleInfoStream moduleInfoStream = dbiStream.CreateModuleInfoStream(rawPdbFile);
     const PDB::SectionContributionStream sectionContributionStream = dbiStream.CreateSectionContributionStream(rawPdbFile);
-    const PDB::CoalescedMSFStream symbolRecordStream = dbiStream.CreateSymbolRecordStream(rawPdbFile);
+    nameStorage.symbolRecordStream = dbiStream.CreateSymbolRecordStream(rawPdbFile);
+    const PDB::CoalescedMSFStream& symbolRecordStream = nameStorage.symbolRecordStream;
 
     // get all section contributions
     const PDB::ArrayView<PDB::DBI::SectionContribution> sectionContributions = sectionContributionStream.GetContributions();
     std::vector<SectionContrib> contributions;
+
+    // Object file index of each module, filled on first use; there are way fewer modules than
+    // contributions. Indices are handed out in the order contributions refer to them, so
+    // that the report ordering stays the same.
+    const PDB::ArrayView<PDB::ModuleInfoStream::Module> modules = moduleInfoStream.GetModules();
+    const size_t moduleCount = modules.GetLength();
+    std::vector<int32_t> moduleObjectFiles(moduleCount, -1);
     size_t sectionContribsSize = sectionContributions.GetLength();
     contributions.reserve(sectionContribsSize);
     to.m_Contribs.reserve(sectionContribsSize);
@@ -227,8 +378,10 @@ static void ReadEverything(const PDB::RawFile& rawPdbFile, const PDB::DBIStream&
         else
             contrib.Type = SectionType::Unknown;
 
-        const PDB::ModuleInfoStream::Module& module = moduleInfoStream.GetModule(srcContrib.moduleIndex);
-        contrib.ObjFileIndex = to.GetObjectFileIndex(module.GetName().Decay());
+        int32_t& objFileIndex = moduleObjectFiles[srcContrib.moduleIndex];
+        if (objFileIndex < 0)
+            objFileIndex = to.GetObjectFileIndex(modules[srcContrib.moduleIndex].GetName().Decay());
+        contrib.ObjFileIndex = objFileIndex;
         contributions.emplace_back(contrib);
 
         ContribInfo info;
@@ -238,65 +391,122 @@ static void ReadEverything(const PDB::RawFile& rawPdbFile, const PDB::DBIStream&
         to.m_Contribs.emplace_back(info);
     }
 
-    RVAToSymbolMap rvaToSymbol;
-    rvaToSymbol.reserve(1024);
+    // contribution lookups need them sorted by section & offset; the DBI stream normally has them that way already
+    auto contribLess = [](const SectionContrib& a, const SectionContrib& b)
+    {
+        return a.Section < b.Section || (a.Section == b.Section && a.Offset < b.Offset);
+    };
+    if (!std::is_sorted(contributions.begin(), contributions.end(), contribLess))
+        std::stable_sort(contributions.begin(), contributions.end(), contribLess);
+    StatsSetCounter("modules", moduleCount);
+    StatsSetCounter("contributions", contributions.size());
+
+    // All symbols go into one flat buffer, in the order a serial read would encounter them
+    // (modules, then globals, then publics); sorting by RVA then keeps the first one at each address.
+    std::vector<PDBSymbol> rvaSortedSymbols;
 
-    // get symbols from the modules
-    const PDB::ArrayView<PDB::ModuleInfoStream::Module> modules = moduleInfoStream.GetModules();
-    size_t moduleCount = modules.GetLength();
-    size_t processedModuleCount = 0;
-    for (const PDB::ModuleInfoStream::Module& module : modules)
+    // get symbols from the modules; their streams are prefetched all at once, as they are
+    // usually small and next to each other
+    stats.Restart("module symbols");
     {
-        ++processedModuleCount;
-        if ((processedModuleCount & 127) == 0)
-            fprintf(stderr, "\b\b\b\b\b\b\b\b[%5.1f%%]", 10.0 + processedModuleCount * 40.0 / moduleCount);
+        std::vector<uint32_t> moduleBlocks;
+        for (const PDB::ModuleInfoStream::Module& module : modules)
+        {
+            if (module.HasSymbolStream())
+                AddStreamBlocks(rawPdbFile, module.GetSymbolStreamIndex(), module.GetSymbolStreamSize(), moduleBlocks);
+        }
+        PrefetchBlocks(pdbFile, rawPdbFile, moduleBlocks);
+    }
+    std::atomic<size_t> processedModuleCount(0);
+    nameStorage.moduleSymbolStreams.resize(moduleCount);
+    CollectSymbols(threadCount, moduleCount, 16, rvaSortedSymbols, [&](size_t moduleIndex, std::vector<PDBSymbol>& dst)
+    {
+        size_t processed = ++processedModuleCount;
+        if ((processed & 127) == 0)
+            fprintf(stderr, "\b\b\b\b\b\b\b\b[%5.1f%%]", 10.0 + processed * 40.0 / moduleCount);
+        const PDB::ModuleInfoStream::Module& module = modules[moduleIndex];
         if (!module.HasSymbolStream())
-            continue;
+            return;
 
-        const PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawPdbFile);
+        PDB::ModuleSymbolStream moduleSymbolStream = module.CreateSymbolStream(rawPdbFile);
+        const size_t firstSymbol = dst.size();
         moduleSymbolStream.ForEachSymbol([&](const PDB::CodeView::DBI::Record* record)
         {
-            ProcessSymbol(imageSectionStream, record, rvaToSymbol);
+            ProcessSymbol(imageSectionStream, record, dst);
         });
-    }
+        if (!moduleSymbolStream.IsCopied())
+        {
+            nameStorage.moduleSymbolStreams[moduleIndex] = std::move(moduleSymbolStream);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(nameStorage.namesMutex);
+        for (size_t i = firstSymbol; i < dst.size(); ++i)
+            dst[i].name = nameStorage.names.CopyToArena(dst[i].name, strlen(dst[i].name));
+    });
 
     // get global symbols
     {
+        stats.Restart("global symbols");
+        PrefetchStream(pdbFile, rawPdbFile, dbiHeader.globalStreamIndex);
         const PDB::GlobalSymbolStream globalSymbolStream = dbiStream.CreateGlobalSymbolStream(rawPdbFile);
         const PDB::ArrayView<PDB::HashRecord> hashRecords = globalSymbolStream.GetRecords();
-        for (const PDB::HashRecord& hashRecord : hashRecords)
+        const size_t chunkCount = (hashRecords.GetLength() + kHashRecordChunkSize - 1) / kHashRecordChunkSize;
+        CollectSymbols(threadCount, chunkCount, 1, rvaSortedSymbols, [&](size_t chunkIndex, std::vector<PDBSymbol>& dst)
         {
-            const PDB::CodeView::DBI::Record* record = globalSymbolStream.GetRecord(symbolRecordStream, hashRecord);
-            ProcessSymbol(imageSectionStream, record, rvaToSymbol);
-        }
+            const size_t end = std::min(hashRecords.GetLength(), (chunkIndex + 1) * kHashRecordChunkSize);
+            for (size_t i = chunkIndex * kHashRecordChunkSize; i < end; ++i)
+            {
+                const PDB::CodeView::DBI::Record* record = globalSymbolStream.GetRecord(symbolRecordStream, hashRecords[i]);
+                ProcessSymbol(imageSectionStream, record, dst);
+            }
+        });
     }
     // There can be public function symbols we haven't seen yet in any of the modules, especially for PDBs that don't provide module-specific information.
     {
+        stats.Restart("public symbols");
+        PrefetchStream(pdbFile, rawPdbFile, dbiHeader.publicStreamIndex);
         const PDB::PublicSymbolStream publicSymbolStream = dbiStream.CreatePublicSymbolStream(rawPdbFile);
         const PDB::ArrayView<PDB::HashRecord> hashRecords = publicSymbolStream.GetRecords();
-        for (const PDB::HashRecord& hashRecord : hashRecords)
+        const size_t chunkCount = (hashRecords.GetLength() + kHashRecordChunkSize - 1) / kHashRecordChunkSize;
+        CollectSymbols(threadCount, chunkCount, 1, rvaSortedSymbols, [&](size_t chunkIndex, std::vector<PDBSymbol>& dst)
         {
-            const PDB::CodeView::DBI::Record* record = publicSymbolStream.GetRecord(symbolRecordStream, hashRecord);
-            ProcessSymbol(imageSectionStream, record, rvaToSymbol);
-        }
+            const size_t end = std::min(hashRecords.GetLength(), (chunkIndex + 1) * kHashRecordChunkSize);
+            for (size_t i = chunkIndex * kHashRecordChunkSize; i < end; ++i)
+            {
+                const PDB::CodeView::DBI::Record* record = publicSymbolStream.GetRecord(symbolRecordStream, hashRecords[i]);
+                ProcessSymbol(imageSectionStream, record, dst);
+            }
+        });
     }
 
-    // Gather all symbols, sort by RVA, figure out sizes of the ones that did not have a size
-    std::vector<PDBSymbol> rvaSortedSymbols;
-    const size_t symbolCount = rvaToSymbol.size();
-    rvaSortedSymbols.reserve(symbolCount);
-    for (const auto& sym : rvaToSymbol)
-        rvaSortedSymbols.push_back(sym.second);
-    rvaToSymbol.clear();
-
-    std::sort(rvaSortedSymbols.begin(), rvaSortedSymbols.end(), [](const auto& a, const auto& b) { return a.rva < b.rva; });
+    // Sort by RVA and dedupe, find their contributions, figure out sizes of the ones that did not have a size
+    stats.Restart("sort symbols");
+    StatsSetCounter("symbol records", rvaSortedSymbols.size());
+    SortAndDedupeSymbols(rvaSortedSymbols);
+    ResolveSymbolContribs(contributions, rvaSortedSymbols);
+    const size_t symbolCount = rvaSortedSymbols.size();
+    StatsSetCounter("symbols", symbolCount);
 
+    stats.Restart("type sizes");
     if (symbolCount != 0)
     {
         const PDB::TPIStream tpiStream = PDB::CreateTPIStream(rawPdbFile);
-        TypeTable typeTable(tpiStream);
 
-        std::unordered_map<uint32_t, size_t> typeSizeCache;
+        // Only symbols without a length need their type looked at (mostly data). When that is a small
+        // part of all the types, reading just those records on demand is much cheaper than coalescing
+        // the whole TPI stream.
+        size_t typeLookupCount = 0;
+        for (const PDBSymbol& sym : rvaSortedSymbols)
+        {
+            if (sym.length == 0 && sym.typeIndex >= tpiStream.GetFirstTypeIndex())
+                ++typeLookupCount;
+        }
+        StatsSetCounter("type lookups", typeLookupCount);
+        const bool lazyTypes = typeLookupCount < tpiStream.GetTypeRecordCount() / 8;
+        if (!lazyTypes)
+            PrefetchStream(pdbFile, rawPdbFile, kTPIStreamIndex);
+        std::unique_ptr<TypeTable> typeTablePtr(lazyTypes ? new TypeTable(rawPdbFile, tpiStream) : new TypeTable(tpiStream));
+        TypeTable& typeTable = *typeTablePtr;
 
         for (size_t i = 0; i < symbolCount; ++i)
         {
@@ -310,22 +520,13 @@ static void ReadEverything(const PDB::RawFile& rawPdbFile, const PDB::DBIStream&
             // Type size:
             if (curr.typeIndex != 0)
             {
-                size_t typeSize = 0;
-                auto it = typeSizeCache.find(curr.typeIndex);
-                if (it != typeSizeCache.end())
-                {
-                    typeSize = it->second;
-                }
-                {
-                    typeSize = PDBGetTypeSize(typeTable, curr.typeIndex);
-                    typeSizeCache.insert({curr.typeIndex, typeSize});
-                }
+                uint32_t typeSize = typeTable.GetTypeSize(curr.typeIndex);
                 if (typeSize != 0)
-                    curr.length = uint32_t(typeSize);
+                    curr.length = typeSize;
             }
 
             // Contribution:
-            const SectionContrib* contrib = ContribFromSectionOffset(contributions.data(), contributions.size(), curr.section, curr.offset);
+            const SectionContrib* contrib = curr.contrib;
             if (contrib && (contrib->Length < curr.length || curr.length == 0))
                 curr.length = contrib->Length;
 
@@ -341,16 +542,33 @@ static void ReadEverything(const PDB::RawFile& rawPdbFile, const PDB::DBIStream&
     }
 
     // Add symbols to the destination map
+    stats.Restart("add symbols");
     size_t addedSymbolCount = 0;
     for (const PDBSymbol& sym : rvaSortedSymbols)
     {
         ++addedSymbolCount;
         if ((addedSymbolCount & 65535) == 0)
             fprintf(stderr, "\b\b\b\b\b\b\b\b[%5.1f%%]", 50.0 + addedSymbolCount * 50.0 / symbolCount);
-        AddSymbol(contributions.data(), contributions.size(), sym.section, sym.offset, sym.name, sym.length, to);
+        AddSymbol(sym.contrib, sym.name, sym.length, to);
     }
 }
 
+// Non-contiguous streams are coalesced by mapping their blocks back to back instead of copying
+// them, if possible. Small streams are cheaper to just copy.
+static void* MapStreamBlocks(const void* fileData, uint32_t blockSize, const uint32_t* blockIndices, uint32_t blockCount)
+{
+    if (blockCount < 16)
+        return nullptr;
+    return MemoryMappedFile::MapBlocks(fileData, blockSize, blockIndices, blockCount);
+}
+
+static const PDB::CoalescedStreamMapper s_StreamMapper = { MapStreamBlocks, MemoryMappedFile::UnmapBlocks };
+
+void SetPDBStreamMapper()
+{
+    PDB::SetCoalescedStreamMapper(&s_StreamMapper);
+}
+
 // check whether the DBI stream offers all sub-streams we need
 static bool HasValidDBIStreams(const PDB::RawFile& rawPdbFile, const PDB::DBIStream& dbiStream)
 {
@@ -365,15 +583,84 @@ static bool HasValidDBIStreams(const PDB::RawFile& rawPdbFile, const PDB::DBIStr
     return true;
 }
 
-bool ReadDebugInfo(const char *fileName, DebugInfo &to)
+static int MakeFolder(const char* path)
+{
+#ifdef _WIN32
+    return _mkdir(path);
+#else
+    return mkdir(path, 0755);
+#endif
+}
+
+// Creates a folder along with any missing parent folders; false (with errno set) if the
+// folder itself could not be created and does not exist.
+static bool MakeFolders(const char* path)
+{
+    // parent levels first, ignoring failures (existing folders, drive names); one that matters
+    // makes creating the folder itself fail
+    std::string parent = path;
+    for (size_t i = 1; i < parent.size(); ++i)
+    {
+        if ((parent[i] == '/' || parent[i] == '\\') && parent[i - 1] != '/' && parent[i - 1] != '\\')
+        {
+            const char separator = parent[i];
+            parent[i] = 0;
+            MakeFolder(parent.c_str());
+            parent[i] = separator;
+        }
+    }
+    return MakeFolder(path) == 0 || errno == EEXIST;
+}
+
+// Cache file for a PDB: its file name plus GUID and age in the cache folder (created along
+// with its parents if needed), so that different builds of a same named PDB each have their
+// own. Empty if the folder can not be created.
+static std::string GetCachePath(const char* cacheDir, const char* fileName, const SnapshotKey& key)
+{
+    if (!MakeFolders(cacheDir))
+    {
+        static bool reported = false;
+        if (!reported)
+            fprintf(stderr, "  failed to create cache folder '%s': %s\n", cacheDir, strerror(errno));
+        reported = true;
+        return std::string();
+    }
+    const char* name = fileName;
+    for (const char* p = fileName; *p; ++p)
+    {
+        if (*p == '/' || *p == '\\')
+            name = p + 1;
+    }
+    std::string path = cacheDir;
+    if (path.back() != '/' && path.back() != '\\')
+        path += '/';
+    path += name;
+    char keyText[16 * 2 + 8 + 2];
+    char* keyPtr = keyText;
+    *keyPtr++ = '-';
+    for (uint8_t b : key.guid)
+        keyPtr += snprintf(keyPtr, 3, "%02x", b);
+    snprintf(keyPtr, 9, "%x", key.age);
+    path += keyText;
+    path += ".szs";
+    return path;
+}
+
+bool ReadDebugInfo(const char *fileName, int threadCount, const char* cacheDir, DebugInfo &to, SnapshotKey* outKey, int mapFlags)
 {
     // open the PDB file
-    MemoryMappedFile pdbFile(fileName);
+    StatsScope stats("mmap");
+    std::shared_ptr<PDBNameStorage> nameStorage = std::make_shared<PDBNameStorage>();
+    nameStorage->file.reset(new MemoryMappedFile(fileName, mapFlags));
+    const MemoryMappedFile& pdbFile = *nameStorage->file;
     if (pdbFile.baseAddress == nullptr)
     {
         fprintf(stderr, "  failed to memory-map PDB file '%s'\n", fileName);
         return false;
     }
+    StatsSetCounter("PDB bytes", pdbFile.fileSize);
+    stats.Restart("validation");
+    SetPDBStreamMapper();
     PDB::ErrorCode errorCode = PDB::ValidateFile(pdbFile.baseAddress);
     if (errorCode != PDB::ErrorCode::Success)
     {
@@ -381,6 +668,8 @@ bool ReadDebugInfo(const char *fileName, DebugInfo &to)
         return false;
     }
     const PDB::RawFile rawPdbFile = PDB::CreateRawFile(pdbFile.baseAddress);
+    PrefetchStream(pdbFile, rawPdbFile, kInfoStreamIndex);
+    PrefetchStream(pdbFile, rawPdbFile, kDBIStreamIndex);
     errorCode = PDB::HasValidDBIStream(rawPdbFile);
     if (errorCode != PDB::ErrorCode::Success)
     {
@@ -409,7 +698,33 @@ bool ReadDebugInfo(const char *fileName, DebugInfo &to)
         printf("Warning: PDB file is stripped, some information might be missing or misleading.\n");
     }
 
-    ReadEverything(rawPdbFile, dbiStream, to);
+    SnapshotKey key;
+    memcpy(key.guid, &infoStream.GetHeader()->guid, sizeof(key.guid));
+    key.age = infoStream.GetHeader()->age;
+    if (outKey != nullptr)
+        *outKey = key;
+    std::string cachePath;
+    if (cacheDir != nullptr && cacheDir[0] != 0)
+    {
+        cachePath = GetCachePath(cacheDir, fileName, key);
+        stats.Restart("load cache");
+        if (!cachePath.empty() && LoadSnapshot(cachePath.c_str(), &key, to))
+        {
+            fprintf(stderr, "  using cached '%s'\n", cachePath.c_str());
+            return true;
+        }
+    }
+
+    stats.End();
+    ReadEverything(rawPdbFile, dbiStream, ResolveThreadCount(threadCount), *nameStorage, to);
+    to.m_NameStorage.emplace_back(std::move(nameStorage));
+
+    if (!cachePath.empty())
+    {
+        stats.Restart("save cache");
+        if (!SaveSnapshot(to, key, cachePath.c_str()))
+            fprintf(stderr, "  failed to write cache file '%s'\n", cachePath.c_str());
+    }
 
     return true;
 }
@@ -5,6 +5,33 @@
 
 #pragma once
 
-class DebugInfo;
+#include "debuginfo.hpp"
 
-bool ReadDebugInfo(const char* fileName, DebugInfo& to);
+struct SnapshotKey;
+
+// Reads symbols & contributions from a PDB file. Module symbol streams are read on
+// threadCount threads (zero: all hardware threads); the result does not depend on it.
+// With a cacheDir, a snapshot of what was read is kept there, and used instead of reading
+// the PDB again as long as it is the same PDB (by its GUID and age). outKey (if given) gets
+// the key of the PDB, for saving snapshots of it. mapFlags are MemoryMappedFile flags for
+// mapping the PDB file.
+bool ReadDebugInfo(const char* fileName, int threadCount, const char* cacheDir, DebugInfo& to, SnapshotKey* outKey = nullptr, int mapFlags = 0);
+
+// Internals of PDB reading, exposed for benchmarks.
+
+struct SectionContrib
+{
+    uint32_t Section;
+    uint32_t Offset;
+    uint32_t Length;
+    uint32_t Compiland;
+    SectionType Type;
+    int32_t ObjFileIndex;
+};
+
+// Binary search for the contribution holding section:offset, in contributions sorted by
+// section & offset; null if there is none.
+const SectionContrib* ContribFromSectionOffset(const SectionContrib* contribs, size_t contribsCount, uint32_t sec, uint32_t offs);
+
+// Sets raw_pdb up to coalesce streams the way ReadDebugInfo has it do.
+void SetPDBStreamMapper();
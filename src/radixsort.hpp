@@ -0,0 +1,53 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <utility>
+#include <vector>
+
+// Stable LSD radix sort of items by a 32-bit key, ascending. Key is a functor
+// returning uint32_t for an item. Byte positions where all keys are the same are
+// skipped, so e.g. RVAs that only differ in the low 24 bits take three passes.
+template <typename T, typename Key>
+void RadixSort32(std::vector<T>& items, Key&& key)
+{
+    const size_t count = items.size();
+    if (count < 2)
+        return;
+
+    size_t histogram[4][256];
+    memset(histogram, 0, sizeof(histogram));
+    for (const T& item : items)
+    {
+        uint32_t k = key(item);
+        ++histogram[0][k & 0xFF];
+        ++histogram[1][(k >> 8) & 0xFF];
+        ++histogram[2][(k >> 16) & 0xFF];
+        ++histogram[3][k >> 24];
+    }
+
+    std::vector<T> scratch(count);
+    for (int pass = 0; pass < 4; ++pass)
+    {
+        size_t* hist = histogram[pass];
+        const int shift = pass * 8;
+        // every key has the same byte here, nothing to do
+        if (hist[(key(items[0]) >> shift) & 0xFF] == count)
+            continue;
+
+        size_t sum = 0;
+        for (int i = 0; i < 256; ++i)
+        {
+            size_t c = hist[i];
+            hist[i] = sum;
+            sum += c;
+        }
+        for (T& item : items)
+            scratch[hist[(key(item) >> shift) & 0xFF]++] = std::move(item);
+        items.swap(scratch);
+    }
+}
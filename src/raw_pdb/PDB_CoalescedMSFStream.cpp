@@ -14,6 +14,8 @@
 
 namespace
 {
+	static const PDB::CoalescedStreamMapper* s_mapper = nullptr;
+
 	// ------------------------------------------------------------------------------------------------
 	// ------------------------------------------------------------------------------------------------
 	PDB_NO_DISCARD static bool AreBlockIndicesContiguous(const uint32_t* blockIndices, uint32_t blockSize, uint32_t streamSize) PDB_NO_EXCEPT
@@ -36,10 +38,21 @@ namespace
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void PDB::SetCoalescedStreamMapper(const CoalescedStreamMapper* mapper) PDB_NO_EXCEPT
+{
+	s_mapper = mapper;
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(void) PDB_NO_EXCEPT
 	: m_ownedData(nullptr)
+	, m_mapper(nullptr)
+	, m_mappedData(nullptr)
+	, m_mappedSize(0u)
 	, m_data(nullptr)
 	, m_size(0u)
 {
@@ -50,10 +63,16 @@ PDB::CoalescedMSFStream::CoalescedMSFStream(void) PDB_NO_EXCEPT
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(CoalescedMSFStream&& other) PDB_NO_EXCEPT
 	: m_ownedData(PDB_MOVE(other.m_ownedData))
+	, m_mapper(PDB_MOVE(other.m_mapper))
+	, m_mappedData(PDB_MOVE(other.m_mappedData))
+	, m_mappedSize(PDB_MOVE(other.m_mappedSize))
 	, m_data(PDB_MOVE(other.m_data))
 	, m_size(PDB_MOVE(other.m_size))
 {
 	other.m_ownedData = nullptr;
+	other.m_mapper = nullptr;
+	other.m_mappedData = nullptr;
+	other.m_mappedSize = 0u;
 	other.m_data = nullptr;
 	other.m_size = 0u;
 }
@@ -66,12 +85,22 @@ PDB::CoalescedMSFStream& PDB::CoalescedMSFStream::operator=(CoalescedMSFStream&&
 	if (this != &other)
 	{
 		PDB_DELETE_ARRAY(m_ownedData);
+		if (m_mappedData)
+		{
+			m_mapper->Unmap(m_mappedData, m_mappedSize);
+		}
 
 		m_ownedData = PDB_MOVE(other.m_ownedData);
+		m_mapper = PDB_MOVE(other.m_mapper);
+		m_mappedData = PDB_MOVE(other.m_mappedData);
+		m_mappedSize = PDB_MOVE(other.m_mappedSize);
 		m_data = PDB_MOVE(other.m_data);
 		m_size = PDB_MOVE(other.m_size);
 
 		other.m_ownedData = nullptr;
+		other.m_mapper = nullptr;
+		other.m_mappedData = nullptr;
+		other.m_mappedSize = 0u;
 		other.m_data = nullptr;
 		other.m_size = 0u;
 	}
@@ -84,6 +113,9 @@ PDB::CoalescedMSFStream& PDB::CoalescedMSFStream::operator=(CoalescedMSFStream&&
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t streamSize) PDB_NO_EXCEPT
 	: m_ownedData(nullptr)
+	, m_mapper(nullptr)
+	, m_mappedData(nullptr)
+	, m_mappedSize(0u)
 	, m_data(nullptr)
 	, m_size(streamSize)
 {
@@ -95,6 +127,11 @@ PDB::CoalescedMSFStream::CoalescedMSFStream(const void* data, uint32_t blockSize
 		const size_t fileOffset = PDB::ConvertBlockIndexToFileOffset(index, blockSize);
 		m_data = Pointer::Offset<const Byte*>(data, fileOffset);
 	}
+	else if (MapBlocks(data, blockSize, blockIndices, PDB::ConvertSizeToBlockCount(streamSize, blockSize)))
+	{
+		// blocks are mapped back to back, no copying needed either
+		m_data = static_cast<const Byte*>(m_mappedData);
+	}
 	else
 	{
 		// slower path, we need to copy disjunct blocks into our own data array, block by block
@@ -136,6 +173,9 @@ PDB::CoalescedMSFStream::CoalescedMSFStream(const void* data, uint32_t blockSize
 // ------------------------------------------------------------------------------------------------
 PDB::CoalescedMSFStream::CoalescedMSFStream(const DirectMSFStream& directStream, uint32_t size, uint32_t offset) PDB_NO_EXCEPT
 	: m_ownedData(nullptr)
+	, m_mapper(nullptr)
+	, m_mappedData(nullptr)
+	, m_mappedSize(0u)
 	, m_data(nullptr)
 	, m_size(size)
 {
@@ -152,6 +192,12 @@ PDB::CoalescedMSFStream::CoalescedMSFStream(const DirectMSFStream& directStream,
 		const size_t offsetWithinData = directStream.GetDataOffsetForIndexAndOffset(indexAndOffset);
 		m_data = Pointer::Offset<const Byte*>(directStream.GetData(), offsetWithinData);
 	}
+	else if (MapBlocks(directStream.GetData(), directStream.GetBlockSize(), directStream.GetBlockIndices() + indexAndOffset.index,
+		PDB::ConvertSizeToBlockCount(indexAndOffset.offsetWithinBlock + size, directStream.GetBlockSize())))
+	{
+		// blocks are mapped back to back, no copying needed either
+		m_data = static_cast<const Byte*>(m_mappedData) + indexAndOffset.offsetWithinBlock;
+	}
 	else
 	{
 		// slower path, we need to copy from disjunct blocks, which is performed by the direct stream
@@ -168,4 +214,30 @@ PDB::CoalescedMSFStream::CoalescedMSFStream(const DirectMSFStream& directStream,
 PDB::CoalescedMSFStream::~CoalescedMSFStream(void) PDB_NO_EXCEPT
 {
 	PDB_DELETE_ARRAY(m_ownedData);
+	if (m_mappedData)
+	{
+		m_mapper->Unmap(m_mappedData, m_mappedSize);
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+bool PDB::CoalescedMSFStream::MapBlocks(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t blockCount) PDB_NO_EXCEPT
+{
+	const CoalescedStreamMapper* mapper = s_mapper;
+	if (!mapper)
+	{
+		return false;
+	}
+
+	m_mappedData = mapper->Map(data, blockSize, blockIndices, blockCount);
+	if (!m_mappedData)
+	{
+		return false;
+	}
+
+	m_mapper = mapper;
+	m_mappedSize = size_t(blockSize) * blockCount;
+	return true;
 }
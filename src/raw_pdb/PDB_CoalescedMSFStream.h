@@ -15,6 +15,20 @@ namespace PDB
 	class PDB_NO_DISCARD DirectMSFStream;
 
 
+	// optional hook that lets coalesced streams present disjunct blocks back to back without copying
+	// them, e.g. by mapping the file's pages next to each other in virtual memory.
+	// Map returns the address of blockCount blocks laid out contiguously, or nullptr to fall back to
+	// copying. Unmap releases such a range.
+	struct CoalescedStreamMapper
+	{
+		void* (*Map)(const void* fileData, uint32_t blockSize, const uint32_t* blockIndices, uint32_t blockCount);
+		void (*Unmap)(void* address, size_t size);
+	};
+
+	// Sets the mapper used by coalesced streams created afterwards; nullptr always copies.
+	void SetCoalescedStreamMapper(const CoalescedStreamMapper* mapper) PDB_NO_EXCEPT;
+
+
 	// provides access to a coalesced version of an MSF stream.
 	// inherently thread-safe, the stream doesn't carry any internal offset or similar.
 	// coalesces all blocks into a contiguous stream of data upon construction.
@@ -39,6 +53,12 @@ namespace PDB
 			return m_size;
 		}
 
+		// Returns whether the data was copied from disjunct blocks, rather than pointing into the file's memory.
+		PDB_NO_DISCARD inline bool IsCopied(void) const PDB_NO_EXCEPT
+		{
+			return m_ownedData != nullptr;
+		}
+
 		// Provides read-only access to the data.
 		template <typename T>
 		PDB_NO_DISCARD inline const T* GetDataAtOffset(size_t offset) const PDB_NO_EXCEPT
@@ -60,11 +80,19 @@ namespace PDB
 		}
 
 	private:
+		// tries to set up the blocks back to back through the stream mapper.
+		PDB_NO_DISCARD bool MapBlocks(const void* data, uint32_t blockSize, const uint32_t* blockIndices, uint32_t blockCount) PDB_NO_EXCEPT;
+
 		// contiguous, coalesced data, can be null
 		Byte* m_ownedData;
 
-		// either points to the owned data that has been copied from disjunct blocks, or points to the
-		// memory-mapped data directly in case all stream blocks are contiguous.
+		// contiguous blocks set up by a CoalescedStreamMapper, can be null
+		const CoalescedStreamMapper* m_mapper;
+		void* m_mappedData;
+		size_t m_mappedSize;
+
+		// either points to the owned data that has been copied from disjunct blocks, into the mapped
+		// blocks, or to the memory-mapped data directly in case all stream blocks are contiguous.
 		const Byte* m_data;
 		size_t m_size;
 
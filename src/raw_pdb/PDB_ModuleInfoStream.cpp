@@ -84,6 +84,23 @@ PDB_NO_DISCARD PDB::ModuleLineStream PDB::ModuleInfoStream::Module::CreateLineSt
 	return ModuleLineStream(file, m_info->moduleSymbolStreamIndex, m_info->symbolSize + m_info->c11Size + m_info->c13Size, m_info->symbolSize + m_info->c11Size);
 }
 
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint16_t PDB::ModuleInfoStream::Module::GetSymbolStreamIndex(void) const PDB_NO_EXCEPT
+{
+	return m_info->moduleSymbolStreamIndex;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::ModuleInfoStream::Module::GetSymbolStreamSize(void) const PDB_NO_EXCEPT
+{
+	return m_info->symbolSize;
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 PDB::ModuleInfoStream::ModuleInfoStream(void) PDB_NO_EXCEPT
@@ -36,6 +36,12 @@ namespace PDB
 			// Create a line stream for the module
 			PDB_NO_DISCARD ModuleLineStream CreateLineStream(const RawFile& file) const PDB_NO_EXCEPT;
 
+			// Returns the index of the module's stream, which holds the symbols at its start.
+			PDB_NO_DISCARD uint16_t GetSymbolStreamIndex(void) const PDB_NO_EXCEPT;
+
+			// Returns the size of the symbols in the module's stream.
+			PDB_NO_DISCARD uint32_t GetSymbolStreamSize(void) const PDB_NO_EXCEPT;
+
 			// Returns the name of the module.
 			PDB_NO_DISCARD inline ArrayView<char> GetName(void) const PDB_NO_EXCEPT
 			{
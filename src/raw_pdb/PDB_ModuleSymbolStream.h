@@ -37,6 +37,12 @@ namespace PDB
 			return m_stream.GetDataAtOffset<const CodeView::DBI::Record>(record.end);
 		}
 
+		// Returns whether the stream's data was copied, rather than pointing into the file's memory.
+		PDB_NO_DISCARD inline bool IsCopied(void) const PDB_NO_EXCEPT
+		{
+			return m_stream.IsCopied();
+		}
+
 		// Finds a record of a certain kind.
 		PDB_NO_DISCARD const CodeView::DBI::Record* FindRecord(CodeView::DBI::SymbolRecordKind Kind) const PDB_NO_EXCEPT;
 
@@ -114,6 +114,14 @@ PDB::RawFile::~RawFile(void) PDB_NO_EXCEPT
 }
 
 
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+PDB_NO_DISCARD uint32_t PDB::RawFile::GetBlockSize(void) const PDB_NO_EXCEPT
+{
+	return m_superBlock->blockSize;
+}
+
+
 // ------------------------------------------------------------------------------------------------
 // ------------------------------------------------------------------------------------------------
 template <typename T>
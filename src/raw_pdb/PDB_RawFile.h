@@ -34,6 +34,27 @@ namespace PDB
 		template <typename T>
 		PDB_NO_DISCARD T CreateMSFStream(uint32_t streamIndex, uint32_t streamSize) const PDB_NO_EXCEPT;
 
+		// Returns the number of streams in the file.
+		PDB_NO_DISCARD inline uint32_t GetStreamCount(void) const PDB_NO_EXCEPT
+		{
+			return m_streamCount;
+		}
+
+		// Returns the size of a stream in bytes.
+		PDB_NO_DISCARD inline uint32_t GetStreamSize(uint32_t streamIndex) const PDB_NO_EXCEPT
+		{
+			return m_streamSizes[streamIndex];
+		}
+
+		// Returns the indices of the blocks a stream is made of, in stream order.
+		PDB_NO_DISCARD inline const uint32_t* GetStreamBlocks(uint32_t streamIndex) const PDB_NO_EXCEPT
+		{
+			return m_streamBlocks[streamIndex];
+		}
+
+		// Returns the size of a block in bytes.
+		PDB_NO_DISCARD uint32_t GetBlockSize(void) const PDB_NO_EXCEPT;
+
 	private:
 		const void* m_data;
 		const SuperBlock* m_superBlock;
@@ -0,0 +1,94 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stdint.h>
+
+enum class ReportFormat
+{
+    Text,       // human readable, sizes in kilobytes
+    JsonLines,  // one JSON object per row
+    Csv,        // one row per line, with a header line
+    Binary,     // columnar, see below
+};
+
+// Lists of a report, in the order they are written. Machine readable formats tag each row
+// with the list name; the binary format has a table for each.
+enum ReportList : uint32_t
+{
+    kReportFunctions,
+    kReportTemplates,
+    kReportData,
+    kReportBSS,
+    kReportNamespaces,
+    kReportObjectFilesCode,
+    kReportObjectFilesData,
+    kReportTotals,
+    kReportListCount
+};
+
+// Columns of report rows; sizes are exact, in bytes. Name, object file and namespace columns
+// are strings; the rest are numbers.
+enum ReportColumn : uint32_t
+{
+    kColumnName,
+    kColumnObjectFile,
+    kColumnNamespace,
+    kColumnSize,
+    kColumnCount,
+    kColumnCodeSize,
+    kColumnDataSize,
+    kColumnContribSize,
+    kColumnSymbolSize,
+    kReportColumnCount
+};
+
+// Binary report layout, little endian; meant to be memory mapped as is:
+//
+//   BinaryReportHeader
+//   column data: uint32_t per row, each column starts at an 8 byte aligned offset;
+//     string columns hold indices into the string table
+//   string table: uint32_t offsets[stringCount + 1] into the string data (8 byte aligned),
+//     then the string data, each string null terminated
+//   BinaryReportTable for each table, each followed by its BinaryReportColumn entries
+//     (8 byte aligned)
+//   BinaryReportFooter, at the very end of the file
+//
+// Everything can be written in one pass: the tables are described in the footer, after
+// the data they point to.
+static const char kBinaryReportMagic[4] = { 'S', 'Z', 'R', 'B' };
+static const uint32_t kBinaryReportVersion = 1;
+
+struct BinaryReportHeader
+{
+    char magic[4];
+    uint32_t version;
+};
+
+struct BinaryReportTable
+{
+    uint32_t list; // ReportList
+    uint32_t rowCount;
+    uint32_t columnCount;
+    uint32_t reserved;
+};
+
+struct BinaryReportColumn
+{
+    uint32_t column; // ReportColumn
+    uint32_t reserved;
+    uint64_t offset; // from file start
+};
+
+struct BinaryReportFooter
+{
+    uint64_t tablesOffset;
+    uint64_t stringOffsetsOffset;
+    uint64_t stringDataOffset;
+    uint32_t stringCount;
+    uint32_t tableCount;
+    char magic[4];
+    uint32_t version;
+};
@@ -0,0 +1,143 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#include "reportwriter.hpp"
+#include <stdarg.h>
+#include <stdio.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+ReportWriter::ReportWriter(int fd)
+    : m_File(fd)
+{
+}
+
+ReportWriter::ReportWriter(std::string& str)
+    : m_String(&str)
+{
+}
+
+void ReportWriter::Printf(const char* format, ...)
+{
+    static const int bufferSize = 512;
+    char buffer[bufferSize];
+    va_list arg;
+
+    va_start(arg, format);
+    int length = vsnprintf(buffer, bufferSize - 1, format, arg);
+    va_end(arg);
+    if (length < 0)
+        return;
+    if (length > bufferSize - 2)
+        length = bufferSize - 2;
+
+    BeginLine();
+    Append(buffer, length);
+    CutOffLine();
+}
+
+void ReportWriter::Write(const char* str, size_t length)
+{
+    if (kBufferSize - m_Used < length)
+    {
+        Flush();
+        if (length > kBufferSize)
+        {
+            Output(str, length);
+            m_Flushed += length;
+            return;
+        }
+    }
+    memcpy(m_Buffer + m_Used, str, length);
+    m_Used += length;
+}
+
+void ReportWriter::AppendPadded(const char* str, size_t length, size_t width)
+{
+    static const char spaces[] = "                                ";
+    static const size_t spaceCount = sizeof(spaces) - 1;
+    Append(str, length);
+    while (length < width)
+    {
+        const size_t n = width - length < spaceCount ? width - length : spaceCount;
+        Append(spaces, n);
+        length += n;
+    }
+}
+
+char* ReportWriter::FormatInt(uint64_t value, char* end)
+{
+    char* p = end;
+    do
+    {
+        *--p = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return p;
+}
+
+void ReportWriter::AppendInt(uint32_t value, int width, char pad)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = FormatInt(value, end);
+    for (int i = int(end - p); i < width; ++i)
+        Append(pad);
+    Append(p, end - p);
+}
+
+void ReportWriter::WriteInt(uint64_t value)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = FormatInt(value, end);
+    Write(p, end - p);
+}
+
+void ReportWriter::WritePadding(size_t alignment)
+{
+    static const char zeros[16] = {};
+    size_t size = size_t(GetWrittenSize() % alignment);
+    if (size != 0)
+        Write(zeros, alignment - size);
+}
+
+void ReportWriter::Flush()
+{
+    Output(m_Buffer, m_Used);
+    m_Flushed += m_Used;
+    m_Used = 0;
+}
+
+void ReportWriter::Output(const char* data, size_t size)
+{
+    if (m_String != nullptr)
+    {
+        m_String->append(data, size);
+        return;
+    }
+    while (size > 0 && m_File != -1)
+    {
+#ifdef _WIN32
+        int written = _write(m_File, data, unsigned(size > 0x40000000 ? 0x40000000 : size));
+#else
+        ssize_t written = write(m_File, data, size);
+        if (written < 0 && errno == EINTR)
+            continue;
+#endif
+        if (written <= 0)
+        {
+            // output is gone (e.g. closed pipe); drop the rest of the report
+            m_File = -1;
+            m_Failed = true;
+            return;
+        }
+        data += written;
+        size -= size_t(written);
+    }
+}
@@ -0,0 +1,101 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+// Streams report text through a fixed size buffer, flushed straight into a file descriptor
+// (or appended to a string). Report lines are either printf-formatted, or built from pieces
+// between BeginLine / EndLine with hand-rolled number formatting.
+//
+// Lines of kLineCutoff characters or more (newline included) are cut to their first
+// kLineCutoff characters and get "...\n" appended; same as the reports always did.
+class ReportWriter
+{
+public:
+    static const size_t kLineCutoff = 507;
+
+    explicit ReportWriter(int fd);
+    explicit ReportWriter(std::string& str);
+    ~ReportWriter() { Flush(); }
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    void Printf(const char* format, ...)
+#ifdef __GNUC__
+        __attribute__((format(printf, 2, 3)))
+#endif
+        ;
+
+    // Raw text or data, not subject to line length limits.
+    void Write(const char* str, size_t length);
+    void Write(char c) { Write(&c, 1); }
+    void WriteInt(uint64_t value);
+    // Zero bytes up to a multiple of alignment (at most 16) in the output.
+    void WritePadding(size_t alignment);
+    // Bytes written so far, buffered ones included.
+    uint64_t GetWrittenSize() const { return m_Flushed + m_Used; }
+
+    void BeginLine()
+    {
+        if (kBufferSize - m_Used < kLineCutoff + 4)
+            Flush();
+        m_LineLength = 0;
+    }
+    void Append(const char* str, size_t length)
+    {
+        const size_t room = m_LineLength < kLineCutoff ? kLineCutoff - m_LineLength : 0;
+        const size_t n = length < room ? length : room;
+        memcpy(m_Buffer + m_Used, str, n);
+        m_Used += n;
+        m_LineLength += length;
+    }
+    void Append(const char* str) { Append(str, strlen(str)); }
+    void Append(char c) { Append(&c, 1); }
+    // Like "%-*s": padded with spaces on the right up to width.
+    void AppendPadded(const char* str, size_t length, size_t width);
+    // Like "%*u" (or "%0*u" with pad '0').
+    void AppendInt(uint32_t value, int width = 0, char pad = ' ');
+    // Size in kilobytes with two decimals, like "%*d.%02d" of size/1024 and (size%1024)*100/1024.
+    void AppendKB(uint32_t size, int width = 0)
+    {
+        AppendInt(size / 1024, width);
+        Append('.');
+        AppendInt((size % 1024) * 100 / 1024, 2, '0');
+    }
+    void EndLine()
+    {
+        Append('\n');
+        CutOffLine();
+    }
+
+    void Flush();
+    // Whether writing into the file descriptor failed; the rest of the output is dropped then.
+    bool HasFailed() const { return m_Failed; }
+
+private:
+    static char* FormatInt(uint64_t value, char* end);
+    void Output(const char* data, size_t size);
+    void CutOffLine()
+    {
+        if (m_LineLength >= kLineCutoff)
+            Write("...\n", 4);
+    }
+
+private:
+    static const size_t kBufferSize = 64 * 1024;
+
+    char m_Buffer[kBufferSize];
+    size_t m_Used = 0;
+    uint64_t m_Flushed = 0;
+    size_t m_LineLength = 0;
+    int m_File = -1;
+    bool m_Failed = false;
+    std::string* m_String = nullptr;
+};
@@ -0,0 +1,347 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#include "snapshot.hpp"
+#include "debuginfo.hpp"
+#include "mmapfile.h"
+#include "reportwriter.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char kSnapshotMagic[4] = { 'S', 'Z', 'S', 'S' };
+static const uint32_t kSnapshotVersion = 3;
+
+enum SnapshotArray
+{
+    kArrayStringOffsets, // string count + 1 offsets into string data
+    kArrayStringHashes,
+    kArrayStringData,
+    kArrayObjectFilePathIds,
+    kArrayObjectFileDirIds,
+    kArrayObjectFileNameIds,
+    kArrayNamespaceNameIds,
+    kArrayContribObjectFiles,
+    kArrayContribSizes,
+    kArrayContribSections,
+    kArraySymbols, // kSymbolColumnCount arrays for each section type
+};
+enum SymbolColumn
+{
+    kSymbolSize,
+    kSymbolObjectFile,
+    kSymbolNamespace,
+    kSymbolName,
+    kSymbolColumnCount
+};
+static const int kSnapshotArrayCount = kArraySymbols + kSectionTypeCount * kSymbolColumnCount;
+
+struct SnapshotHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint8_t guid[16];
+    uint32_t age;
+    uint32_t reserved;
+    struct
+    {
+        uint64_t offset;
+        uint64_t count;
+    } arrays[kSnapshotArrayCount];
+};
+
+bool SnapshotKey::operator==(const SnapshotKey& o) const
+{
+    return memcmp(guid, o.guid, sizeof(guid)) == 0 && age == o.age;
+}
+
+// Creates a new file, failing if it already exists.
+static int CreateForWriting(const char* path)
+{
+#ifdef _WIN32
+    return _open(path, _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+#endif
+}
+
+// Temporary file name next to path, unique among processes (and saves within one), so that
+// several runs saving the same snapshot at once do not write into each other's file.
+static std::string GetTempPath(const char* path)
+{
+    static std::atomic<uint32_t> s_Counter(0);
+#ifdef _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = int(getpid());
+#endif
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%d-%u.tmp", pid, s_Counter.fetch_add(1));
+    return std::string(path) + suffix;
+}
+
+static bool CloseFile(int fd)
+{
+#ifdef _WIN32
+    return _close(fd) == 0;
+#else
+    return close(fd) == 0;
+#endif
+}
+
+bool SaveSnapshot(const DebugInfo& info, const SnapshotKey& key, const char* path)
+{
+    // gather the arrays
+    struct ArrayData
+    {
+        const void* data = nullptr;
+        size_t count = 0;
+        size_t elementSize = sizeof(uint32_t);
+    };
+    ArrayData arrays[kSnapshotArrayCount];
+
+    const StringPool& strings = info.m_Strings;
+    const uint32_t stringCount = strings.GetCount();
+    std::vector<uint32_t> stringOffsets(stringCount + 1);
+    std::vector<uint32_t> stringHashes(stringCount);
+    uint64_t stringDataSize = 0;
+    for (uint32_t i = 0; i < stringCount; ++i)
+    {
+        stringDataSize += strings.GetLength(i) + 1;
+        if (stringDataSize > 0xFFFFFFFFu)
+            return false;
+        stringOffsets[i + 1] = uint32_t(stringDataSize);
+        stringHashes[i] = strings.GetHash(i);
+    }
+    arrays[kArrayStringOffsets].data = stringOffsets.data();
+    arrays[kArrayStringOffsets].count = stringOffsets.size();
+    arrays[kArrayStringHashes].data = stringHashes.data();
+    arrays[kArrayStringHashes].count = stringHashes.size();
+    arrays[kArrayStringData].count = stringOffsets.back();
+    arrays[kArrayStringData].elementSize = 1;
+
+    const size_t objectCount = info.m_ObjectFiles.size();
+    std::vector<uint32_t> objectPathIds(objectCount), objectDirIds(objectCount), objectNameIds(objectCount);
+    for (size_t i = 0; i < objectCount; ++i)
+    {
+        objectPathIds[i] = info.m_ObjectFiles[i].pathId;
+        objectDirIds[i] = info.m_ObjectFiles[i].fileDirId;
+        objectNameIds[i] = info.m_ObjectFiles[i].fileNameId;
+    }
+    arrays[kArrayObjectFilePathIds] = { objectPathIds.data(), objectCount };
+    arrays[kArrayObjectFileDirIds] = { objectDirIds.data(), objectCount };
+    arrays[kArrayObjectFileNameIds] = { objectNameIds.data(), objectCount };
+
+    const size_t namespaceCount = info.m_Namespaces.size();
+    std::vector<uint32_t> namespaceNameIds(namespaceCount);
+    for (size_t i = 0; i < namespaceCount; ++i)
+        namespaceNameIds[i] = info.m_Namespaces[i].nameId;
+    arrays[kArrayNamespaceNameIds] = { namespaceNameIds.data(), namespaceCount };
+
+    const size_t contribCount = info.m_Contribs.size();
+    std::vector<uint32_t> contribObjectFiles(contribCount), contribSizes(contribCount), contribSections(contribCount);
+    for (size_t i = 0; i < contribCount; ++i)
+    {
+        contribObjectFiles[i] = uint32_t(info.m_Contribs[i].objectFileIndex);
+        contribSizes[i] = info.m_Contribs[i].size;
+        contribSections[i] = uint32_t(info.m_Contribs[i].sectionType);
+    }
+    arrays[kArrayContribObjectFiles] = { contribObjectFiles.data(), contribCount };
+    arrays[kArrayContribSizes] = { contribSizes.data(), contribCount };
+    arrays[kArrayContribSections] = { contribSections.data(), contribCount };
+
+    for (int type = 0; type < kSectionTypeCount; ++type)
+    {
+        const SymbolTable& syms = info.m_Symbols[type];
+        ArrayData* columns = &arrays[kArraySymbols + type * kSymbolColumnCount];
+        columns[kSymbolSize] = { syms.size.data(), syms.GetCount() };
+        columns[kSymbolObjectFile] = { syms.objectFileIndex.data(), syms.GetCount() };
+        columns[kSymbolNamespace] = { syms.namespaceIndex.data(), syms.GetCount() };
+        columns[kSymbolName] = { syms.nameId.data(), syms.GetCount() };
+    }
+
+    // header with where everything will be
+    SnapshotHeader header = {};
+    memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    memcpy(header.guid, key.guid, sizeof(header.guid));
+    header.age = key.age;
+    uint64_t offset = sizeof(header);
+    for (int i = 0; i < kSnapshotArrayCount; ++i)
+    {
+        offset = (offset + 7) & ~uint64_t(7);
+        header.arrays[i].offset = offset;
+        header.arrays[i].count = arrays[i].count;
+        offset += arrays[i].count * arrays[i].elementSize;
+    }
+
+    std::string tempPath = GetTempPath(path);
+    int fd = CreateForWriting(tempPath.c_str());
+    if (fd == -1)
+        return false;
+    bool ok;
+    {
+        ReportWriter out(fd);
+        out.Write((const char*)&header, sizeof(header));
+        for (int i = 0; i < kSnapshotArrayCount; ++i)
+        {
+            out.WritePadding(8);
+            if (i == kArrayStringData)
+            {
+                for (uint32_t id = 0; id < stringCount; ++id)
+                    out.Write(strings.GetString(id), strings.GetLength(id) + 1);
+            }
+            else
+            {
+                out.Write((const char*)arrays[i].data, arrays[i].count * arrays[i].elementSize);
+            }
+        }
+        out.Flush();
+        ok = !out.HasFailed() && out.GetWrittenSize() == offset;
+    }
+    ok = CloseFile(fd) && ok;
+    if (ok)
+    {
+#ifdef _WIN32
+        remove(path); // rename does not replace existing files there
+#endif
+        ok = rename(tempPath.c_str(), path) == 0;
+    }
+    if (!ok)
+        remove(tempPath.c_str());
+    return ok;
+}
+
+bool LoadSnapshot(const char* path, const SnapshotKey* expectedKey, DebugInfo& to, SnapshotKey* outKey)
+{
+    std::shared_ptr<MemoryMappedFile> file = std::make_shared<MemoryMappedFile>(path);
+    if (file->baseAddress == nullptr || file->fileSize < sizeof(SnapshotHeader))
+        return false;
+    const char* base = (const char*)file->baseAddress;
+    const SnapshotHeader& header = *(const SnapshotHeader*)base;
+    if (memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 || header.version != kSnapshotVersion)
+        return false;
+    SnapshotKey key;
+    memcpy(key.guid, header.guid, sizeof(key.guid));
+    key.age = header.age;
+    if (outKey != nullptr)
+        *outKey = key;
+    if (expectedKey != nullptr && key != *expectedKey)
+        return false;
+
+    // all arrays within the file
+    for (int i = 0; i < kSnapshotArrayCount; ++i)
+    {
+        const uint64_t elementSize = i == kArrayStringData ? 1 : sizeof(uint32_t);
+        const uint64_t offset = header.arrays[i].offset;
+        const uint64_t count = header.arrays[i].count;
+        if (offset % 8 != 0 || offset > file->fileSize || count > (file->fileSize - offset) / elementSize)
+            return false;
+    }
+    auto getArray = [&](int index) { return (const uint32_t*)(base + header.arrays[index].offset); };
+    auto getCount = [&](int index) { return header.arrays[index].count; };
+
+    // strings; null terminated, offsets within the data
+    const uint64_t stringCount = getCount(kArrayStringHashes);
+    if (getCount(kArrayStringOffsets) != stringCount + 1 || stringCount >= 0xFFFFFFFFu)
+        return false;
+    const uint32_t* stringOffsets = getArray(kArrayStringOffsets);
+    const uint32_t* stringHashes = getArray(kArrayStringHashes);
+    const char* stringData = base + header.arrays[kArrayStringData].offset;
+    if (stringOffsets[0] != 0 || stringOffsets[stringCount] != getCount(kArrayStringData))
+        return false;
+    for (uint64_t i = 0; i < stringCount; ++i)
+    {
+        if (stringOffsets[i + 1] <= stringOffsets[i] || stringData[stringOffsets[i + 1] - 1] != 0)
+            return false;
+    }
+
+    // references between the arrays are in range
+    auto allBelow = [&](int index, uint64_t limit)
+    {
+        const uint32_t* values = getArray(index);
+        for (uint64_t i = 0, n = getCount(index); i < n; ++i)
+            if (values[i] >= limit)
+                return false;
+        return true;
+    };
+    const uint64_t objectCount = getCount(kArrayObjectFilePathIds);
+    const uint64_t namespaceCount = getCount(kArrayNamespaceNameIds);
+    const uint64_t contribCount = getCount(kArrayContribSizes);
+    if (getCount(kArrayObjectFileDirIds) != objectCount || getCount(kArrayObjectFileNameIds) != objectCount ||
+        getCount(kArrayContribObjectFiles) != contribCount || getCount(kArrayContribSections) != contribCount)
+        return false;
+    if (!allBelow(kArrayObjectFilePathIds, stringCount) || !allBelow(kArrayObjectFileDirIds, stringCount) || !allBelow(kArrayObjectFileNameIds, stringCount) ||
+        !allBelow(kArrayNamespaceNameIds, stringCount) ||
+        !allBelow(kArrayContribObjectFiles, objectCount) || !allBelow(kArrayContribSections, kSectionTypeCount))
+        return false;
+    for (int type = 0; type < kSectionTypeCount; ++type)
+    {
+        const int columns = kArraySymbols + type * kSymbolColumnCount;
+        const uint64_t symbolCount = getCount(columns + kSymbolSize);
+        for (int c = 0; c < kSymbolColumnCount; ++c)
+            if (getCount(columns + c) != symbolCount)
+                return false;
+        if (!allBelow(columns + kSymbolObjectFile, objectCount) || !allBelow(columns + kSymbolNamespace, namespaceCount) || !allBelow(columns + kSymbolName, stringCount))
+            return false;
+    }
+
+    // everything checks out, fill in
+    to.m_Strings.Reserve(size_t(stringCount));
+    for (uint32_t i = 0; i < stringCount; ++i)
+        to.m_Strings.AddRestored(stringData + stringOffsets[i], stringOffsets[i + 1] - stringOffsets[i] - 1, stringHashes[i]);
+
+    const uint32_t* objectPathIds = getArray(kArrayObjectFilePathIds);
+    const uint32_t* objectDirIds = getArray(kArrayObjectFileDirIds);
+    const uint32_t* objectNameIds = getArray(kArrayObjectFileNameIds);
+    for (uint64_t i = 0; i < objectCount; ++i)
+        to.AddObjectFile(objectPathIds[i], objectDirIds[i], objectNameIds[i]);
+
+    const uint32_t* namespaceNameIds = getArray(kArrayNamespaceNameIds);
+    for (uint64_t i = 0; i < namespaceCount; ++i)
+        to.AddNamespace(namespaceNameIds[i]);
+
+    const uint32_t* contribObjectFiles = getArray(kArrayContribObjectFiles);
+    const uint32_t* contribSizes = getArray(kArrayContribSizes);
+    const uint32_t* contribSections = getArray(kArrayContribSections);
+    to.m_Contribs.resize(size_t(contribCount));
+    for (uint64_t i = 0; i < contribCount; ++i)
+    {
+        ContribInfo& info = to.m_Contribs[i];
+        info.objectFileIndex = int32_t(contribObjectFiles[i]);
+        info.size = contribSizes[i];
+        info.sectionType = SectionType(contribSections[i]);
+    }
+
+    for (int type = 0; type < kSectionTypeCount; ++type)
+    {
+        const int columns = kArraySymbols + type * kSymbolColumnCount;
+        const size_t symbolCount = size_t(getCount(columns + kSymbolSize));
+        SymbolTable& syms = to.m_Symbols[type];
+        const uint32_t* sizes = getArray(columns + kSymbolSize);
+        const int32_t* objectFiles = (const int32_t*)getArray(columns + kSymbolObjectFile);
+        const int32_t* namespaces = (const int32_t*)getArray(columns + kSymbolNamespace);
+        const uint32_t* names = getArray(columns + kSymbolName);
+        syms.size.assign(sizes, sizes + symbolCount);
+        syms.objectFileIndex.assign(objectFiles, objectFiles + symbolCount);
+        syms.namespaceIndex.assign(namespaces, namespaces + symbolCount);
+        syms.nameId.assign(names, names + symbolCount);
+        uint32_t sectionSize = 0;
+        for (size_t i = 0; i < symbolCount; ++i)
+            sectionSize += sizes[i];
+        to.m_SectionSizes[type] = sectionSize;
+    }
+
+    // strings point into the mapped file
+    to.m_NameStorage.emplace_back(std::move(file));
+    return true;
+}
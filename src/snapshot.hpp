@@ -0,0 +1,39 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stdint.h>
+
+class DebugInfo;
+
+// Identifies the PDB a snapshot was made from: GUID and age from its info stream header.
+struct SnapshotKey
+{
+    uint8_t guid[16] = {};
+    uint32_t age = 0;
+
+    bool operator==(const SnapshotKey& o) const;
+    bool operator!=(const SnapshotKey& o) const { return !(*this == o); }
+};
+
+// A snapshot is DebugInfo as read from a PDB (symbols, contributions, object files,
+// namespaces and all the strings), before ComputeDerivedData. It is a columnar file that
+// loads by memory mapping it without parsing: strings (with their offsets and StringPool
+// hashes) are used in place, other columns are plain copies. Most of its size is the
+// strings; expect roughly 60% of the size of the PDB.
+//
+// Layout, little endian:
+//   SnapshotHeader, with offset and element count of each SnapshotArray
+//   the arrays, each starting at an 8 byte aligned offset; uint32_t elements, except for
+//   the string data which is bytes (each string null terminated)
+//
+// Bump kSnapshotVersion whenever the layout, what DebugInfo contents mean, or
+// StringPool::Hash changes.
+
+// Saves into path (via a temporary file, so readers never see a partial one).
+bool SaveSnapshot(const DebugInfo& info, const SnapshotKey& key, const char* path);
+// Loads into an empty DebugInfo. Fails on a missing or invalid file, or (when expectedKey is
+// given) when the snapshot was made from a different PDB; outKey gets the snapshot's key.
+bool LoadSnapshot(const char* path, const SnapshotKey* expectedKey, DebugInfo& to, SnapshotKey* outKey = nullptr);
@@ -0,0 +1,218 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#include "stats.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Set once by StatsEnable, before any worker threads start.
+static bool s_Enabled = false;
+
+// Heap allocations (count and requested bytes, on all threads) are counted by replacing the
+// global operator new, only while recording is enabled; otherwise an allocation just checks
+// s_Enabled.
+static std::atomic<uint64_t> s_AllocCount(0);
+static std::atomic<uint64_t> s_AllocBytes(0);
+
+void* operator new(size_t size)
+{
+    if (s_Enabled)
+    {
+        s_AllocCount.fetch_add(1, std::memory_order_relaxed);
+        s_AllocBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (size == 0)
+        size = 1;
+    for (;;)
+    {
+        if (void* ptr = malloc(size))
+            return ptr;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new(size); }
+    catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    try { return operator new(size); }
+    catch (...) { return nullptr; }
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+
+struct StatsPhase
+{
+    const char* name;
+    int depth;
+    double wallTime, cpuTime; // at start, then durations once done
+    uint64_t allocCount, allocBytes; // likewise
+    uint64_t peakRSS;
+};
+
+struct StatsCounter
+{
+    const char* name;
+    uint64_t value;
+};
+
+static int s_Depth = 0;
+static std::vector<StatsPhase> s_Phases;
+static std::vector<StatsCounter> s_Counters;
+
+void StatsEnable()
+{
+    s_Enabled = true;
+    s_Phases.reserve(64);
+    s_Counters.reserve(64);
+}
+
+bool StatsEnabled()
+{
+    return s_Enabled;
+}
+
+void StatsScope::Begin(const char* name)
+{
+    if (!s_Enabled)
+        return;
+    m_Index = int(s_Phases.size());
+    StatsPhase phase;
+    phase.name = name;
+    phase.depth = s_Depth++;
+    phase.peakRSS = 0;
+    phase.allocCount = s_AllocCount.load(std::memory_order_relaxed);
+    phase.allocBytes = s_AllocBytes.load(std::memory_order_relaxed);
+    phase.cpuTime = GetCPUTime();
+    phase.wallTime = GetWallTime();
+    s_Phases.push_back(phase);
+}
+
+void StatsScope::End()
+{
+    if (m_Index < 0)
+        return;
+    StatsPhase& phase = s_Phases[m_Index];
+    m_Index = -1;
+    phase.wallTime = GetWallTime() - phase.wallTime;
+    phase.cpuTime = GetCPUTime() - phase.cpuTime;
+    phase.allocCount = s_AllocCount.load(std::memory_order_relaxed) - phase.allocCount;
+    phase.allocBytes = s_AllocBytes.load(std::memory_order_relaxed) - phase.allocBytes;
+    phase.peakRSS = GetPeakRSS();
+    --s_Depth;
+}
+
+void StatsSetCounter(const char* name, uint64_t value)
+{
+    if (!s_Enabled)
+        return;
+    for (StatsCounter& counter : s_Counters)
+    {
+        if (strcmp(counter.name, name) == 0)
+        {
+            counter.value = value;
+            return;
+        }
+    }
+    s_Counters.push_back({ name, value });
+}
+
+void StatsWriteText(FILE* f)
+{
+    fprintf(f, "%-36s %10s %10s %10s %10s %12s\n", "Phase", "wall ms", "CPU ms", "allocs", "alloc MB", "peak RSS MB");
+    for (const StatsPhase& phase : s_Phases)
+    {
+        fprintf(f, "%*s%-*s %10.1f %10.1f %10llu %10.1f %12.1f\n",
+            phase.depth * 2, "", 36 - phase.depth * 2, phase.name,
+            phase.wallTime * 1000.0, phase.cpuTime * 1000.0,
+            (unsigned long long)phase.allocCount, phase.allocBytes / (1024.0 * 1024.0),
+            phase.peakRSS / (1024.0 * 1024.0));
+    }
+    if (!s_Counters.empty())
+    {
+        fprintf(f, "Counter\n");
+        for (const StatsCounter& counter : s_Counters)
+            fprintf(f, "  %-34s %10llu\n", counter.name, (unsigned long long)counter.value);
+    }
+}
+
+void StatsWriteJson(FILE* f)
+{
+    // names are fixed identifiers, no escaping needed
+    fprintf(f, "{\"phases\":[");
+    for (size_t i = 0; i < s_Phases.size(); ++i)
+    {
+        const StatsPhase& phase = s_Phases[i];
+        fprintf(f, "%s\n{\"name\":\"%s\",\"depth\":%d,\"wall_ms\":%.3f,\"cpu_ms\":%.3f,\"allocs\":%llu,\"alloc_bytes\":%llu,\"peak_rss_bytes\":%llu}",
+            i == 0 ? "" : ",", phase.name, phase.depth,
+            phase.wallTime * 1000.0, phase.cpuTime * 1000.0,
+            (unsigned long long)phase.allocCount, (unsigned long long)phase.allocBytes,
+            (unsigned long long)phase.peakRSS);
+    }
+    fprintf(f, "\n],\"counters\":{");
+    for (size_t i = 0; i < s_Counters.size(); ++i)
+        fprintf(f, "%s\n\"%s\":%llu", i == 0 ? "" : ",", s_Counters[i].name, (unsigned long long)s_Counters[i].value);
+    fprintf(f, "\n}}\n");
+}
+
+double GetWallTime()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+double GetCPUTime()
+{
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return 0.0;
+    auto toSeconds = [](const FILETIME& t) { return ((uint64_t(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1.0e-7; };
+    return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1.0e-6;
+#endif
+}
+
+uint64_t GetPeakRSS()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return uint64_t(usage.ru_maxrss); // bytes
+#else
+    return uint64_t(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
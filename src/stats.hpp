@@ -0,0 +1,53 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Sizer's own performance, for --stats: phases marked with StatsScope record wall and CPU
+// time, heap allocations made while they ran, and peak memory use at their end. Phases can
+// nest; they are reported in the order they started. Counters are named numbers (symbol
+// counts etc.). Only the main thread is expected to start phases and set counters; CPU time
+// and allocations are of the whole process though, worker threads included.
+//
+// Recording is off unless StatsEnable was called (before starting any threads); until then
+// scopes, counters and heap allocations cost nothing extra but a check of a flag. Once on,
+// every heap allocation adds to two shared atomic counters.
+
+void StatsEnable();
+bool StatsEnabled();
+
+class StatsScope
+{
+public:
+    explicit StatsScope(const char* name) { Begin(name); }
+    ~StatsScope() { End(); }
+
+    // Ends the phase and starts the next one, for code going through phases one after another.
+    void Restart(const char* name) { End(); Begin(name); }
+    // Ends the phase before the scope does.
+    void End();
+
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+
+private:
+    void Begin(const char* name);
+
+private:
+    int m_Index = -1;
+};
+
+void StatsSetCounter(const char* name, uint64_t value);
+
+void StatsWriteText(FILE* f);
+void StatsWriteJson(FILE* f);
+
+// Seconds since some fixed point, of wall clock and of CPU time used by the process.
+double GetWallTime();
+double GetCPUTime();
+// Largest amount of physical memory the process has used so far, in bytes.
+uint64_t GetPeakRSS();
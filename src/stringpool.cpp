@@ -0,0 +1,127 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#include "stringpool.hpp"
+
+static const size_t kInitialTableSize = 1024; // power of two
+static const size_t kChunkSize = 256 * 1024;
+
+uint32_t StringPool::Hash(const char* str, size_t length)
+{
+    // 8 bytes at a time, multiply & xor-shift mixing; names are often long (templates), this
+    // is several times faster than a byte at a time hash like FNV-1a
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, str + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, str + i, length - i);
+    hash = (hash ^ tail) * 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 29;
+    return uint32_t(hash);
+}
+
+StringPool::StringPool()
+    : m_Table(kInitialTableSize, 0)
+{
+}
+
+uint32_t StringPool::InternImpl(const char* str, size_t length, bool copy)
+{
+    const uint32_t hash = Hash(str, length);
+    const size_t mask = m_Table.size() - 1;
+    size_t slot = hash & mask;
+    while (m_Table[slot] != 0)
+    {
+        const uint32_t id = m_Table[slot] - 1;
+        if (m_Hashes[id] == hash && m_Lengths[id] == length && memcmp(m_Strings[id], str, length) == 0)
+            return id;
+        slot = (slot + 1) & mask;
+    }
+
+    const uint32_t id = uint32_t(m_Strings.size());
+    m_Strings.push_back(copy ? CopyToArena(str, length) : str);
+    m_Lengths.push_back(uint32_t(length));
+    m_Hashes.push_back(hash);
+    m_Table[slot] = id + 1;
+
+    // keep load factor under 1/2
+    if (m_Strings.size() * 2 > m_Table.size())
+        Rehash(m_Table.size() * 2);
+    return id;
+}
+
+void StringPool::Reserve(size_t count)
+{
+    m_Strings.reserve(count);
+    m_Lengths.reserve(count);
+    m_Hashes.reserve(count);
+    size_t tableSize = m_Table.size();
+    while (count * 2 > tableSize)
+        tableSize *= 2;
+    if (tableSize != m_Table.size())
+        Rehash(tableSize);
+}
+
+void StringPool::AddRestored(const char* str, uint32_t length, uint32_t hash)
+{
+    const size_t mask = m_Table.size() - 1;
+    size_t slot = hash & mask;
+    while (m_Table[slot] != 0)
+        slot = (slot + 1) & mask;
+
+    const uint32_t id = uint32_t(m_Strings.size());
+    m_Strings.push_back(str);
+    m_Lengths.push_back(length);
+    m_Hashes.push_back(hash);
+    m_Table[slot] = id + 1;
+
+    if (m_Strings.size() * 2 > m_Table.size())
+        Rehash(m_Table.size() * 2);
+}
+
+const char* StringPool::CopyToArena(const char* str, size_t length)
+{
+    const size_t size = length + 1;
+    if (size > m_ChunkLeft)
+    {
+        // long strings get a chunk of their own, without wasting the rest of the current one
+        const size_t chunkSize = size > kChunkSize / 4 ? size : kChunkSize;
+        m_Chunks.emplace_back(new char[chunkSize]);
+        char* chunk = m_Chunks.back().get();
+        if (chunkSize != kChunkSize)
+        {
+            memcpy(chunk, str, length);
+            chunk[length] = 0;
+            return chunk;
+        }
+        m_ChunkPtr = chunk;
+        m_ChunkLeft = chunkSize;
+    }
+    char* dst = m_ChunkPtr;
+    memcpy(dst, str, length);
+    dst[length] = 0;
+    m_ChunkPtr += size;
+    m_ChunkLeft -= size;
+    return dst;
+}
+
+void StringPool::Rehash(size_t tableSize)
+{
+    std::vector<uint32_t> table(tableSize, 0);
+    const size_t mask = table.size() - 1;
+    for (uint32_t id = 0, n = uint32_t(m_Strings.size()); id < n; ++id)
+    {
+        size_t slot = m_Hashes[id] & mask;
+        while (table[slot] != 0)
+            slot = (slot + 1) & mask;
+        table[slot] = id + 1;
+    }
+    m_Table.swap(table);
+}
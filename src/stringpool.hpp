@@ -0,0 +1,56 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <vector>
+
+// Interns strings and hands out dense 32-bit IDs for them (0, 1, 2, ... in order of
+// first appearance); equal strings always get the same ID. Copies of strings live
+// in an arena of large chunks, so pointers from GetString stay valid for the lifetime
+// of the pool. Lookup is an open-addressing hash table with linear probing.
+class StringPool
+{
+public:
+    StringPool();
+
+    // Returns ID of the string, copying it into the pool if it was not seen before.
+    uint32_t Intern(const char* str, size_t length) { return InternImpl(str, length, true); }
+    uint32_t Intern(const char* str) { return Intern(str, strlen(str)); }
+    // Same, but a new string is not copied: it has to be null terminated and outlive the pool.
+    uint32_t InternBorrowed(const char* str, size_t length) { return InternImpl(str, length, false); }
+    uint32_t InternBorrowed(const char* str) { return InternBorrowed(str, strlen(str)); }
+    // Copies a string into the arena without interning it; the copy is null terminated.
+    const char* CopyToArena(const char* str, size_t length);
+
+    const char* GetString(uint32_t id) const { return m_Strings[id]; }
+    uint32_t GetLength(uint32_t id) const { return m_Lengths[id]; }
+    uint32_t GetHash(uint32_t id) const { return m_Hashes[id]; }
+    uint32_t GetCount() const { return uint32_t(m_Strings.size()); }
+
+    // For restoring a saved pool: adds a borrowed string that is known not to be in the pool
+    // yet, with its Hash, as the next ID. Reserve room for them first.
+    void Reserve(size_t count);
+    void AddRestored(const char* str, uint32_t length, uint32_t hash);
+
+    static uint32_t Hash(const char* str, size_t length);
+
+private:
+    uint32_t InternImpl(const char* str, size_t length, bool copy);
+    void Rehash(size_t tableSize);
+
+private:
+    std::vector<const char*> m_Strings;
+    std::vector<uint32_t> m_Lengths;
+    std::vector<uint32_t> m_Hashes;
+    std::vector<uint32_t> m_Table; // string ID + 1 per slot, 0 for empty slots
+
+    std::vector<std::unique_ptr<char[]>> m_Chunks;
+    char* m_ChunkPtr = nullptr;
+    size_t m_ChunkLeft = 0;
+};
@@ -0,0 +1,477 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+//
+// Microbenchmarks of Sizer's hot kernels, on a generated PDB (or a given one). Each kernel
+// runs a number of repetitions; only the kernel itself is timed, not setting up its input.
+// Warm mode runs one untimed repetition first. Cold mode instead evicts CPU caches before
+// every repetition, and for kernels that read the PDB, drops the file from the OS page
+// cache (where possible) and maps it anew.
+
+#include "debuginfo.hpp"
+#include "mmapfile.h"
+#include "parg.h"
+#include "pdb_typetable.hpp"
+#include "pdbfile.hpp"
+#include "pdbgen.hpp"
+#include "reportwriter.hpp"
+#include "stats.hpp"
+#include "raw_pdb/PDB.h"
+#include "raw_pdb/PDB_DBIStream.h"
+#include "raw_pdb/PDB_RawFile.h"
+#include "raw_pdb/PDB_TPIStream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BenchOptions
+{
+    int reps = 10;
+    bool cold = false;
+    bool json = false;
+    std::string pdb;
+    std::string only;
+    uint32_t scale = 1;
+    uint32_t seed = 1;
+    float fragmentation = 0.0f;
+};
+
+// The PDB file and the raw_pdb streams everything else comes from.
+struct BenchPDB
+{
+    std::unique_ptr<MemoryMappedFile> file;
+    std::unique_ptr<PDB::RawFile> raw;
+    std::unique_ptr<PDB::DBIStream> dbi;
+    std::unique_ptr<PDB::ModuleInfoStream> moduleInfo;
+
+    bool Open(const char* path, bool dropPageCache)
+    {
+        Close();
+        file.reset(new MemoryMappedFile(path));
+        if (file->baseAddress == nullptr)
+        {
+            fprintf(stderr, "ERROR: failed to memory-map '%s'\n", path);
+            return false;
+        }
+        // reading the file then has to go to the disk (no-op on Windows)
+        if (dropPageCache)
+            file->Advise(0, file->fileSize, MemoryMappedFile::Access::DontNeed);
+        if (PDB::ValidateFile(file->baseAddress) != PDB::ErrorCode::Success)
+        {
+            fprintf(stderr, "ERROR: '%s' is not a valid PDB file\n", path);
+            return false;
+        }
+        raw.reset(new PDB::RawFile(file->baseAddress));
+        if (PDB::HasValidDBIStream(*raw) != PDB::ErrorCode::Success || PDB::HasValidTPIStream(*raw) != PDB::ErrorCode::Success)
+        {
+            fprintf(stderr, "ERROR: '%s' does not have valid DBI and TPI streams\n", path);
+            return false;
+        }
+        dbi.reset(new PDB::DBIStream(PDB::CreateDBIStream(*raw)));
+        moduleInfo.reset(new PDB::ModuleInfoStream(dbi->CreateModuleInfoStream(*raw)));
+        return true;
+    }
+    void Close()
+    {
+        moduleInfo.reset();
+        dbi.reset();
+        raw.reset();
+        file.reset();
+    }
+};
+
+// Kernel inputs that do not depend on the PDB staying mapped.
+struct BenchInputs
+{
+    std::vector<std::string> symbolNames;
+    std::vector<std::string> objectPaths;
+    std::vector<SectionContrib> contribs; // sorted by section & offset
+    std::vector<SectionContrib> queries; // section & offset of each symbol
+    std::vector<uint32_t> typeIndices; // of data symbols
+};
+
+static void CollectInputs(const BenchPDB& pdb, BenchInputs& in)
+{
+    for (const PDB::ModuleInfoStream::Module& module : pdb.moduleInfo->GetModules())
+        in.objectPaths.emplace_back(module.GetName().Decay());
+
+    const PDB::SectionContributionStream contribStream = pdb.dbi->CreateSectionContributionStream(*pdb.raw);
+    for (const PDB::DBI::SectionContribution& src : contribStream.GetContributions())
+    {
+        SectionContrib contrib = {};
+        contrib.Section = src.section;
+        contrib.Offset = src.offset;
+        contrib.Length = src.size;
+        contrib.Compiland = src.moduleIndex;
+        in.contribs.push_back(contrib);
+    }
+    std::stable_sort(in.contribs.begin(), in.contribs.end(), [](const SectionContrib& a, const SectionContrib& b) {
+        return a.Section < b.Section || (a.Section == b.Section && a.Offset < b.Offset);
+    });
+
+    using namespace PDB::CodeView::DBI;
+    for (const PDB::ModuleInfoStream::Module& module : pdb.moduleInfo->GetModules())
+    {
+        if (!module.HasSymbolStream())
+            continue;
+        const PDB::ModuleSymbolStream stream = module.CreateSymbolStream(*pdb.raw);
+        stream.ForEachSymbol([&](const Record* record)
+        {
+            const char* name = nullptr;
+            SectionContrib query = {};
+            uint32_t typeIndex = 0;
+            switch (record->header.kind)
+            {
+            case SymbolRecordKind::S_LPROC32: name = record->data.S_LPROC32.name; query.Section = record->data.S_LPROC32.section; query.Offset = record->data.S_LPROC32.offset; break;
+            case SymbolRecordKind::S_GPROC32: name = record->data.S_GPROC32.name; query.Section = record->data.S_GPROC32.section; query.Offset = record->data.S_GPROC32.offset; break;
+            case SymbolRecordKind::S_GPROC32_ID: name = record->data.S_GPROC32_ID.name; query.Section = record->data.S_GPROC32_ID.section; query.Offset = record->data.S_GPROC32_ID.offset; break;
+            case SymbolRecordKind::S_LDATA32: name = record->data.S_LDATA32.name; query.Section = record->data.S_LDATA32.section; query.Offset = record->data.S_LDATA32.offset; typeIndex = record->data.S_LDATA32.typeIndex; break;
+            case SymbolRecordKind::S_LTHREAD32: name = record->data.S_LTHREAD32.name; query.Section = record->data.S_LTHREAD32.section; query.Offset = record->data.S_LTHREAD32.offset; typeIndex = record->data.S_LTHREAD32.typeIndex; break;
+            default: return;
+            }
+            if (name[0] == 0)
+                return;
+            in.symbolNames.emplace_back(name);
+            in.queries.push_back(query);
+            if (typeIndex != 0)
+                in.typeIndices.push_back(typeIndex);
+        });
+    }
+}
+
+// Touches a buffer larger than any CPU cache, so that whatever the kernel uses is evicted.
+static void EvictCPUCaches()
+{
+    static std::vector<uint8_t> buffer(64 * 1024 * 1024);
+    for (size_t i = 0; i < buffer.size(); i += 64)
+        buffer[i] += 1;
+}
+
+struct BenchResult
+{
+    const char* name;
+    uint64_t items = 0;
+    uint64_t checksum = 0;
+    std::vector<double> times; // seconds
+};
+
+// A kernel: prepare sets up a repetition (untimed), run does the timed work and returns the
+// number of items processed; results go into checksum, so they can not be optimized away.
+struct BenchKernel
+{
+    const char* name;
+    bool usesPDB;
+    std::function<void()> prepare;
+    std::function<uint64_t(uint64_t& checksum)> run;
+};
+
+// release drops whatever kernels keep that points into the PDB, before it gets mapped anew.
+static BenchResult RunKernel(const BenchKernel& kernel, const BenchOptions& opt, const char* pdbPath, BenchPDB& pdb, const std::function<void()>& release)
+{
+    BenchResult result;
+    result.name = kernel.name;
+    const int warmupReps = opt.cold ? 0 : 1;
+    for (int rep = -warmupReps; rep < opt.reps; ++rep)
+    {
+        if (opt.cold)
+        {
+            if (kernel.usesPDB)
+            {
+                release();
+                if (!pdb.Open(pdbPath, true))
+                    exit(1);
+            }
+        }
+        if (kernel.prepare)
+            kernel.prepare();
+        if (opt.cold)
+            EvictCPUCaches();
+        uint64_t checksum = 0;
+        const double start = GetWallTime();
+        const uint64_t items = kernel.run(checksum);
+        const double time = GetWallTime() - start;
+        if (rep < 0)
+            continue;
+        result.items = items;
+        result.checksum = checksum;
+        result.times.push_back(time);
+    }
+    return result;
+}
+
+static double Median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) * 0.5;
+}
+
+static void WriteResults(const std::vector<BenchResult>& results, const BenchOptions& opt, const GenOptions& gen)
+{
+    if (opt.json)
+    {
+        printf("{\"mode\":\"%s\",\"reps\":%d,", opt.cold ? "cold" : "warm", opt.reps);
+        if (opt.pdb.empty())
+            printf("\"generated\":{\"scale\":%u,\"seed\":%u,\"fragmentation\":%.2f},", gen.scale, gen.seed, gen.fragmentation);
+        printf("\"kernels\":[");
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult& r = results[i];
+            const double median = Median(r.times);
+            double sum = 0.0;
+            for (double t : r.times)
+                sum += t;
+            printf("%s\n{\"name\":\"%s\",\"items\":%llu,\"checksum\":%llu,\"min_ms\":%.4f,\"median_ms\":%.4f,\"mean_ms\":%.4f,\"ns_per_item\":%.3f,\"times_ms\":[",
+                i == 0 ? "" : ",", r.name, (unsigned long long)r.items, (unsigned long long)r.checksum,
+                *std::min_element(r.times.begin(), r.times.end()) * 1000.0, median * 1000.0, sum / r.times.size() * 1000.0,
+                r.items ? median * 1.0e9 / r.items : 0.0);
+            for (size_t j = 0; j < r.times.size(); ++j)
+                printf("%s%.4f", j == 0 ? "" : ",", r.times[j] * 1000.0);
+            printf("]}");
+        }
+        printf("\n]}\n");
+        return;
+    }
+
+    printf("%s mode, %d repetitions\n", opt.cold ? "Cold" : "Warm", opt.reps);
+    printf("%-28s %10s %10s %10s %10s %10s\n", "Kernel", "items", "min ms", "median ms", "mean ms", "ns/item");
+    for (const BenchResult& r : results)
+    {
+        const double median = Median(r.times);
+        double sum = 0.0;
+        for (double t : r.times)
+            sum += t;
+        printf("%-28s %10llu %10.3f %10.3f %10.3f %10.2f\n", r.name, (unsigned long long)r.items,
+            *std::min_element(r.times.begin(), r.times.end()) * 1000.0, median * 1000.0, sum / r.times.size() * 1000.0,
+            r.items ? median * 1.0e9 / r.items : 0.0);
+    }
+}
+
+static void print_help()
+{
+    BenchOptions def;
+    fprintf(stderr, "Usage: SizerBench [options]\n");
+    fprintf(stderr, " -r n   or --reps=n           Timed repetitions of each kernel (default %d)\n", def.reps);
+    fprintf(stderr, "           --cold             Evict caches before each repetition, instead of a warm-up run\n");
+    fprintf(stderr, "           --json             Print results as JSON\n");
+    fprintf(stderr, " -k str or --kernel=str       Only run kernels with 'str' in their name\n");
+    fprintf(stderr, " -p file or --pdb=file        Use this PDB file, instead of generating one\n");
+    fprintf(stderr, " -x n   or --scale=n          Scale of the generated PDB, see SizerGenPDB (default %u)\n", def.scale);
+    fprintf(stderr, " -s n   or --seed=n           Random seed of the generated PDB (default %u)\n", def.seed);
+    fprintf(stderr, "           --fragment=f       Fraction of MSF blocks to scatter in the generated PDB (default %.1f)\n", def.fragmentation);
+    fprintf(stderr, " -h or --help                 Print this help\n");
+}
+
+int main(int argc, char* const* argv)
+{
+    BenchOptions opt;
+    parg_state args;
+    parg_init(&args);
+    static const struct parg_option argsTable[] =
+    {
+        { "reps", PARG_REQARG, NULL, 'r' },
+        { "cold", PARG_NOARG, NULL, 'c' },
+        { "json", PARG_NOARG, NULL, 'J' },
+        { "kernel", PARG_REQARG, NULL, 'k' },
+        { "pdb", PARG_REQARG, NULL, 'p' },
+        { "scale", PARG_REQARG, NULL, 'x' },
+        { "seed", PARG_REQARG, NULL, 's' },
+        { "fragment", PARG_REQARG, NULL, 'f' },
+        { "help", PARG_NOARG, NULL, 'h' },
+        { 0, 0, 0, 0 }
+    };
+    int c;
+    while ((c = parg_getopt_long(&args, argc, argv, "r:k:p:x:s:h", argsTable, NULL)) != -1)
+    {
+        switch (c)
+        {
+        case 'r': opt.reps = std::max(1, atoi(args.optarg)); break;
+        case 'c': opt.cold = true; break;
+        case 'J': opt.json = true; break;
+        case 'k': opt.only = args.optarg; break;
+        case 'p': opt.pdb = args.optarg; break;
+        case 'x': opt.scale = uint32_t(std::max(1, atoi(args.optarg))); break;
+        case 's': opt.seed = uint32_t(atoi(args.optarg)); break;
+        case 'f': opt.fragmentation = float(atof(args.optarg)); break;
+        case '?':
+            fprintf(stderr, "Unknown argument or missing value for '%c'\n", args.optopt);
+            // fall through
+        case 1:
+        case 'h':
+        default:
+            print_help();
+            return 0;
+        }
+    }
+
+    GenOptions gen;
+    gen.scale = opt.scale;
+    gen.seed = opt.seed;
+    gen.fragmentation = opt.fragmentation;
+    std::string pdbPath = opt.pdb;
+    if (pdbPath.empty())
+    {
+        pdbPath = "SizerBench-" + std::to_string(gen.seed) + "-" + std::to_string(gen.scale) + ".pdb";
+        if (!GeneratePDB(gen, pdbPath.c_str()))
+            return 1;
+    }
+
+    SetPDBStreamMapper();
+    BenchPDB pdb;
+    BenchInputs in;
+    bool ok = pdb.Open(pdbPath.c_str(), false);
+    if (ok)
+        CollectInputs(pdb, in);
+    if (!ok || in.symbolNames.empty())
+    {
+        if (ok)
+            fprintf(stderr, "ERROR: no symbols in '%s'\n", pdbPath.c_str());
+        if (opt.pdb.empty())
+            remove(pdbPath.c_str());
+        return 1;
+    }
+
+    std::vector<BenchKernel> kernels;
+
+    std::string templateName;
+    kernels.push_back({ "StripTemplateParams", false, nullptr, [&](uint64_t& checksum) {
+        for (const std::string& name : in.symbolNames)
+            if (StripTemplateParams(name.c_str(), templateName))
+                checksum += templateName.size();
+        return uint64_t(in.symbolNames.size());
+    } });
+
+    kernels.push_back({ "ContribFromSectionOffset", false, nullptr, [&](uint64_t& checksum) {
+        for (const SectionContrib& q : in.queries)
+        {
+            const SectionContrib* contrib = ContribFromSectionOffset(in.contribs.data(), in.contribs.size(), q.Section, q.Offset);
+            checksum += contrib ? uint64_t(contrib - in.contribs.data()) : 0;
+        }
+        return uint64_t(in.queries.size());
+    } });
+
+    std::unique_ptr<PDB::TPIStream> tpiStream;
+    std::unique_ptr<TypeTable> typeTable;
+    kernels.push_back({ "PDBGetTypeSize", true, [&]() {
+        typeTable.reset();
+        tpiStream.reset(new PDB::TPIStream(PDB::CreateTPIStream(*pdb.raw)));
+        typeTable.reset(new TypeTable(*tpiStream));
+    }, [&](uint64_t& checksum) {
+        for (uint32_t typeIndex : in.typeIndices)
+            checksum += PDBGetTypeSize(*typeTable, typeIndex);
+        return uint64_t(in.typeIndices.size());
+    } });
+
+    std::unique_ptr<DebugInfo> info;
+    kernels.push_back({ "GetNameSpaceIndex", false, [&]() { info.reset(new DebugInfo()); }, [&](uint64_t& checksum) {
+        for (const std::string& name : in.symbolNames)
+            checksum += info->GetNameSpaceIndex(name.c_str());
+        return uint64_t(in.symbolNames.size());
+    } });
+
+    kernels.push_back({ "GetObjectFileIndex", false, [&]() { info.reset(new DebugInfo()); }, [&](uint64_t& checksum) {
+        for (const std::string& path : in.objectPaths)
+            checksum += info->GetObjectFileIndex(path.c_str());
+        return uint64_t(in.objectPaths.size());
+    } });
+
+    kernels.push_back({ "CoalescedMSFStream", true, nullptr, [&](uint64_t& checksum) {
+        // the symbol record stream, and each module's symbol stream
+        uint64_t count = 1;
+        {
+            const PDB::CoalescedMSFStream stream = pdb.dbi->CreateSymbolRecordStream(*pdb.raw);
+            checksum += stream.GetSize();
+        }
+        for (const PDB::ModuleInfoStream::Module& module : pdb.moduleInfo->GetModules())
+        {
+            if (!module.HasSymbolStream())
+                continue;
+            const PDB::ModuleSymbolStream stream = module.CreateSymbolStream(*pdb.raw);
+            ++count;
+        }
+        checksum += count;
+        return count;
+    } });
+
+    std::vector<PDB::ModuleSymbolStream> moduleStreams;
+    kernels.push_back({ "ForEachSymbol", true, [&]() {
+        moduleStreams.clear();
+        for (const PDB::ModuleInfoStream::Module& module : pdb.moduleInfo->GetModules())
+            if (module.HasSymbolStream())
+                moduleStreams.push_back(module.CreateSymbolStream(*pdb.raw));
+    }, [&](uint64_t& checksum) {
+        uint64_t count = 0;
+        for (const PDB::ModuleSymbolStream& stream : moduleStreams)
+        {
+            stream.ForEachSymbol([&](const PDB::CodeView::DBI::Record* record)
+            {
+                checksum += uint16_t(record->header.kind);
+                ++count;
+            });
+        }
+        return count;
+    } });
+
+    std::string report;
+    kernels.push_back({ "ReportWriter lines", false, [&]() { report.clear(); report.reserve(64 * 1024 * 1024); }, [&](uint64_t& checksum) {
+        // like the functions list: "%5d.%02d: %-*s %s\n" of size in KB, name and object file
+        {
+            ReportWriter out(report);
+            for (size_t i = 0; i < in.symbolNames.size(); ++i)
+            {
+                const std::string& name = in.symbolNames[i];
+                const std::string& path = in.objectPaths[i % in.objectPaths.size()];
+                out.BeginLine();
+                out.AppendKB(uint32_t(name.size() * 1000 + i), 5);
+                out.Append(": ", 2);
+                out.AppendPadded(name.c_str(), name.size(), 80);
+                out.Append(' ');
+                out.Append(path.c_str(), path.size());
+                out.EndLine();
+            }
+        }
+        checksum += report.size();
+        return uint64_t(in.symbolNames.size());
+    } });
+
+    kernels.push_back({ "ReportWriter Printf", false, [&]() { report.clear(); report.reserve(64 * 1024 * 1024); }, [&](uint64_t& checksum) {
+        {
+            ReportWriter out(report);
+            for (size_t i = 0; i < in.symbolNames.size(); ++i)
+            {
+                const std::string& name = in.symbolNames[i];
+                const uint32_t size = uint32_t(name.size() * 1000 + i);
+                out.Printf("%5d.%02d: %-80s %s\n", size / 1024, (size % 1024) * 100 / 1024, name.c_str(), in.objectPaths[i % in.objectPaths.size()].c_str());
+            }
+        }
+        checksum += report.size();
+        return uint64_t(in.symbolNames.size());
+    } });
+
+    auto release = [&]()
+    {
+        typeTable.reset();
+        tpiStream.reset();
+        moduleStreams.clear();
+        info.reset();
+    };
+    std::vector<BenchResult> results;
+    for (const BenchKernel& kernel : kernels)
+    {
+        if (!opt.only.empty() && strstr(kernel.name, opt.only.c_str()) == nullptr)
+            continue;
+        results.push_back(RunKernel(kernel, opt, pdbPath.c_str(), pdb, release));
+        release();
+    }
+    pdb.Close();
+    if (opt.pdb.empty())
+        remove(pdbPath.c_str());
+
+    WriteResults(results, opt, gen);
+    return 0;
+}
@@ -0,0 +1,925 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#include "pdbgen.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------------------------------------------
+// Deterministic random numbers (splitmix64), so that the same options always produce the same file.
+
+struct Random
+{
+    uint64_t state;
+    explicit Random(uint64_t seed) : state(seed) { }
+    uint64_t Next()
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+    // uniform in [lo, hi]
+    uint32_t Range(uint32_t lo, uint32_t hi) { return lo + uint32_t(Next() % (uint64_t(hi) - lo + 1)); }
+    bool Chance(float p) { return (Next() >> 40) < uint64_t(p * float(1 << 24)); }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Little-endian byte buffer with CodeView record helpers.
+
+struct Buffer
+{
+    std::vector<uint8_t> data;
+
+    size_t Size() const { return data.size(); }
+    void U8(uint8_t v) { data.push_back(v); }
+    void U16(uint16_t v) { U8(uint8_t(v)); U8(uint8_t(v >> 8)); }
+    void U32(uint32_t v) { U16(uint16_t(v)); U16(uint16_t(v >> 16)); }
+    void Bytes(const void* src, size_t size) { data.insert(data.end(), (const uint8_t*)src, (const uint8_t*)src + size); }
+    void Str(const std::string& s) { Bytes(s.c_str(), s.size() + 1); }
+    void Zeros(size_t n) { data.insert(data.end(), n, 0); }
+    void Align(size_t a) { while (data.size() % a) U8(0); }
+    void Patch16(size_t at, uint16_t v) { data[at] = uint8_t(v); data[at + 1] = uint8_t(v >> 8); }
+    void Patch32(size_t at, uint32_t v) { Patch16(at, uint16_t(v)); Patch16(at + 2, uint16_t(v >> 16)); }
+
+    // Starts a CodeView record (2 byte size, 2 byte kind); returns its offset for EndRecord.
+    size_t BeginRecord(uint16_t kind) { size_t at = Size(); U16(0); U16(kind); return at; }
+    // Ends a CodeView record, padding it to 4 bytes (symbol records use zeros, type records LF_PAD bytes).
+    void EndRecord(size_t at, bool typePadding)
+    {
+        while (data.size() % 4)
+            U8(typePadding ? uint8_t(0xF0 + 4 - data.size() % 4) : 0);
+        Patch16(at, uint16_t(Size() - at - 2));
+    }
+};
+
+// CodeView constants (see raw_pdb PDB_DBITypes.h / PDB_TPITypes.h)
+enum : uint16_t
+{
+    S_END = 0x0006, S_LDATA32 = 0x110C, S_GDATA32 = 0x110D, S_PUB32 = 0x110E,
+    S_LPROC32 = 0x110F, S_GPROC32 = 0x1110, S_LTHREAD32 = 0x1112, S_GTHREAD32 = 0x1113,
+    S_PROCREF = 0x1125, S_GPROC32_ID = 0x1147, S_OBJNAME = 0x1101,
+
+    LF_MODIFIER = 0x1001, LF_POINTER = 0x1002, LF_PROCEDURE = 0x1008, LF_ARGLIST = 0x1201, LF_BITFIELD = 0x1205,
+    LF_ARRAY = 0x1503, LF_CLASS = 0x1504, LF_STRUCTURE = 0x1505, LF_UNION = 0x1506, LF_ENUM = 0x1507,
+    LF_USHORT = 0x8002, LF_ULONG = 0x8004,
+};
+
+static const uint32_t kTypeIndexBegin = 0x1000;
+static const uint32_t kBasicTypes[] = { 0x0074 /*T_INT4*/, 0x0075 /*T_UINT4*/, 0x0040 /*T_REAL32*/, 0x0041 /*T_REAL64*/,
+    0x0013 /*T_QUAD*/, 0x0023 /*T_UQUAD*/, 0x0020 /*T_UCHAR*/, 0x0030 /*T_BOOL08*/, 0x0603 /*T_64PVOID*/, 0x0011 /*T_SHORT*/ };
+
+// ------------------------------------------------------------------------------------------------
+// Names
+
+static const char* kWords[] = {
+    "Render", "Mesh", "Texture", "Shader", "Audio", "Physics", "Scene", "Node", "Asset", "Buffer",
+    "Stream", "Vector", "Matrix", "Light", "Camera", "Anim", "Skin", "Bone", "Input", "Net",
+    "Socket", "Job", "Task", "Pool", "Alloc", "Heap", "String", "Hash", "Map", "List",
+    "Queue", "Cache", "File", "Path", "Image", "Font", "Glyph", "Layout", "Widget", "Event",
+};
+static const char* kTemplates[] = { "vector", "map", "unique_ptr", "Array", "HashMap", "function", "pair", "Handle" };
+static const char* kNamespaces[] = { "std", "core", "gfx", "audio", "phys", "ui", "net", "detail", "util", "io" };
+
+static std::string MakeIdentifier(Random& rnd, const GenOptions& opt)
+{
+    uint32_t len = rnd.Range(opt.nameMinLength, opt.nameMaxLength);
+    std::string s;
+    while (s.size() < len)
+        s += kWords[rnd.Range(0, sizeof(kWords) / sizeof(kWords[0]) - 1)];
+    s.resize(len);
+    return s;
+}
+
+static std::string MakeTemplateArg(Random& rnd, const GenOptions& opt, uint32_t depth)
+{
+    if (depth == 0 || rnd.Chance(0.5f))
+    {
+        static const char* kArgs[] = { "int", "float", "char", "unsigned int", "bool", "double" };
+        if (rnd.Chance(0.5f))
+            return kArgs[rnd.Range(0, 5)];
+        return std::string(kNamespaces[rnd.Range(0, 9)]) + "::" + MakeIdentifier(rnd, opt);
+    }
+    std::string s = std::string("std::") + kTemplates[rnd.Range(0, 7)] + "<";
+    uint32_t args = rnd.Range(1, 2);
+    for (uint32_t i = 0; i < args; ++i)
+    {
+        if (i)
+            s += ",";
+        s += MakeTemplateArg(rnd, opt, depth - 1);
+    }
+    s += ">";
+    return s;
+}
+
+static std::string MakeSymbolName(Random& rnd, const GenOptions& opt)
+{
+    std::string s;
+    uint32_t scopes = rnd.Range(0, 3);
+    for (uint32_t i = 0; i < scopes; ++i)
+    {
+        s += kNamespaces[rnd.Range(0, 9)];
+        s += "::";
+    }
+    if (rnd.Chance(0.6f))
+    {
+        if (opt.templateDepth > 0 && rnd.Chance(0.4f))
+        {
+            // templated classes come from a small pool, so that instantiations aggregate
+            static const char* kClasses[] = { "Array", "Vector", "HashMap", "Handle", "Span", "Ref", "Optional", "Pool" };
+            s += kClasses[rnd.Range(0, 7)];
+            s += "<";
+            s += MakeTemplateArg(rnd, opt, rnd.Range(0, opt.templateDepth - 1));
+            s += ">";
+        }
+        else
+        {
+            s += MakeIdentifier(rnd, opt);
+        }
+        s += "::";
+    }
+    s += rnd.Chance(0.3f) ? std::string(kWords[rnd.Range(0, 39)]) : MakeIdentifier(rnd, opt);
+    if (opt.templateDepth > 0 && rnd.Chance(0.15f))
+    {
+        s += "<";
+        s += MakeTemplateArg(rnd, opt, opt.templateDepth - 1);
+        s += ">";
+    }
+    return s;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Type records (TPI)
+
+struct TypeStream
+{
+    Buffer records;
+    std::vector<uint32_t> offsets; // offset of each record within `records`
+    std::vector<uint32_t> dataTypes; // type indices usable for data symbols
+
+    uint32_t NextIndex() const { return kTypeIndexBegin + uint32_t(offsets.size()); }
+
+    static void Numeric(Buffer& b, uint32_t v)
+    {
+        if (v < 0x8000) b.U16(uint16_t(v));
+        else if (v < 0x10000) { b.U16(LF_USHORT); b.U16(uint16_t(v)); }
+        else { b.U16(LF_ULONG); b.U32(v); }
+    }
+
+    uint32_t Add(Buffer& rec)
+    {
+        offsets.push_back(uint32_t(records.Size()));
+        records.Bytes(rec.data.data(), rec.Size());
+        return NextIndex() - 1;
+    }
+
+    uint32_t Class(Random& rnd, const GenOptions& opt)
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(rnd.Chance(0.5f) ? LF_CLASS : LF_STRUCTURE);
+        b.U16(uint16_t(rnd.Range(1, 20))); // count
+        b.U16(0); // property
+        b.U32(0); b.U32(0); b.U32(0); // field, derived, vshape
+        uint32_t size = rnd.Chance(0.1f) ? rnd.Range(0x8000, 0x200000) : rnd.Range(1, 4096);
+        Numeric(b, size);
+        b.Str(MakeIdentifier(rnd, opt));
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+    uint32_t Union(Random& rnd, const GenOptions& opt)
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(LF_UNION);
+        b.U16(2); b.U16(0); b.U32(0);
+        Numeric(b, rnd.Range(4, 256));
+        b.Str(MakeIdentifier(rnd, opt));
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+    uint32_t Array(Random& rnd, uint32_t elemType)
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(LF_ARRAY);
+        b.U32(elemType); b.U32(0x0075);
+        Numeric(b, rnd.Chance(0.2f) ? rnd.Range(0x10000, 0x400000) : rnd.Range(4, 0x7fff));
+        b.U8(0); // empty name
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+    uint32_t Modifier(uint32_t type)
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(LF_MODIFIER);
+        b.U32(type); b.U16(1); // const
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+    uint32_t Pointer(uint32_t type, bool is64)
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(LF_POINTER);
+        b.U32(type); b.U32(is64 ? (0x0c | (8u << 13)) : (0x0a | (4u << 13)));
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+    uint32_t Enum(Random& rnd, const GenOptions& opt)
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(LF_ENUM);
+        b.U16(3); b.U16(0); b.U32(rnd.Chance(0.5f) ? 0x0074 : 0x0020); b.U32(0);
+        b.Str(MakeIdentifier(rnd, opt));
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+    uint32_t Bitfield(uint32_t type)
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(LF_BITFIELD);
+        b.U32(type); b.U8(3); b.U8(0);
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+    uint32_t Procedure()
+    {
+        Buffer b;
+        size_t at = b.BeginRecord(LF_PROCEDURE);
+        b.U32(0x0003); b.U8(0); b.U8(0); b.U16(0); b.U32(0);
+        b.EndRecord(at, true);
+        return Add(b);
+    }
+
+    void Generate(Random& rnd, const GenOptions& opt)
+    {
+        while (offsets.size() < opt.typeCount)
+        {
+            uint32_t pick = rnd.Range(0, 99);
+            uint32_t basic = kBasicTypes[rnd.Range(0, sizeof(kBasicTypes) / sizeof(kBasicTypes[0]) - 1)];
+            uint32_t prev = offsets.empty() ? basic : kTypeIndexBegin + rnd.Range(0, uint32_t(offsets.size()) - 1);
+            uint32_t t;
+            if (pick < 30) t = Class(rnd, opt);
+            else if (pick < 35) t = Union(rnd, opt);
+            else if (pick < 50) t = Array(rnd, rnd.Chance(0.5f) ? basic : prev);
+            else if (pick < 62) t = Modifier(rnd.Chance(0.3f) ? basic : prev);
+            else if (pick < 72) t = Pointer(prev, rnd.Chance(0.8f));
+            else if (pick < 80) t = Enum(rnd, opt);
+            else if (pick < 84) t = Bitfield(basic);
+            else if (pick < 90) t = Procedure();
+            else
+            {
+                // chains of modifiers, to stress recursive type size lookups
+                t = prev;
+                uint32_t depth = rnd.Range(2, 6);
+                for (uint32_t i = 0; i < depth && offsets.size() < opt.typeCount; ++i)
+                    t = Modifier(t);
+            }
+            dataTypes.push_back(t);
+        }
+        for (uint32_t b : kBasicTypes)
+            dataTypes.push_back(b);
+    }
+
+    // TPI hash stream: a (empty) hash value buffer, followed by the type index / offset pairs
+    // that let readers jump close to any type without walking the whole stream.
+    void WriteHashStream(Buffer& out, uint32_t& indexOffsetOffset, uint32_t& indexOffsetLength) const
+    {
+        indexOffsetOffset = uint32_t(out.Size());
+        uint32_t lastOffset = 0;
+        for (size_t i = 0; i < offsets.size(); ++i)
+        {
+            if (i == 0 || offsets[i] - lastOffset >= 8192)
+            {
+                out.U32(kTypeIndexBegin + uint32_t(i));
+                out.U32(offsets[i]);
+                lastOffset = offsets[i];
+            }
+        }
+        indexOffsetLength = uint32_t(out.Size()) - indexOffsetOffset;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+// Image sections and contributions
+
+enum Sec { kSecText = 1, kSecRData = 2, kSecData = 3, kSecBSS = 4, kSecCount = 4 };
+static const char* kSectionNames[] = { ".text", ".rdata", ".data", ".bss" };
+static const uint32_t kSectionChars[] = { 0x60000020, 0x40000040, 0xC0000040, 0xC0000080 };
+
+struct Contrib
+{
+    uint16_t section;
+    uint32_t offset;
+    uint32_t size;
+    uint16_t module;
+};
+
+struct Symbol
+{
+    std::string name;
+    uint16_t kind;
+    uint16_t section;
+    uint32_t offset;
+    uint32_t codeSize;
+    uint32_t typeIndex;
+};
+
+struct Module
+{
+    std::string name;
+    std::string objName;
+    std::vector<Symbol> symbols; // go into the module symbol stream
+    bool hasSymbols = true;
+};
+
+static std::string MakeModulePath(Random& rnd, const GenOptions& opt, uint32_t index)
+{
+    static const char* kDirs[] = { "C:\\build\\engine\\", "C:\\build\\editor\\", "D:\\src\\thirdparty\\", "C:\\build\\runtime\\", "" };
+    uint32_t dir = rnd.Range(0, 4);
+    std::string file = MakeIdentifier(rnd, opt);
+    // some object files share names across folders
+    if (rnd.Chance(0.1f))
+        file = kWords[index % 8];
+    std::string path = std::string(kDirs[dir]);
+    if (dir != 4 && rnd.Chance(0.5f))
+        path += std::string(kNamespaces[rnd.Range(0, 9)]) + "\\";
+    return path + file + ".obj";
+}
+
+// ------------------------------------------------------------------------------------------------
+// MSF container
+
+struct MSFWriter
+{
+    uint32_t blockSize;
+    std::vector<Buffer> streams;
+
+    uint32_t AddStream() { streams.emplace_back(); return uint32_t(streams.size() - 1); }
+
+    static bool IsFPMBlock(uint32_t block, uint32_t blockSize)
+    {
+        uint32_t m = block % blockSize;
+        return m == 1 || m == 2;
+    }
+
+    bool Write(const char* path, Random& rnd, float fragmentation)
+    {
+        // collect blocks needed by all the streams, in stream order
+        struct BlockRef { uint32_t stream, index; };
+        std::vector<BlockRef> refs;
+        for (uint32_t s = 0; s < streams.size(); ++s)
+        {
+            uint32_t count = uint32_t((streams[s].Size() + blockSize - 1) / blockSize);
+            for (uint32_t i = 0; i < count; ++i)
+                refs.push_back({ s, i });
+        }
+        // fragment: swap a portion of blocks with random other positions
+        if (fragmentation > 0.0f && refs.size() > 1)
+        {
+            size_t swaps = size_t(refs.size() * fragmentation);
+            for (size_t i = 0; i < swaps; ++i)
+            {
+                size_t a = size_t(rnd.Next() % refs.size());
+                size_t b = size_t(rnd.Next() % refs.size());
+                std::swap(refs[a], refs[b]);
+            }
+        }
+
+        // assign physical blocks: 0 = super block, 1/2 = free page maps (repeated every blockSize blocks)
+        std::vector<std::vector<uint32_t>> streamBlocks(streams.size());
+        for (uint32_t s = 0; s < streams.size(); ++s)
+            streamBlocks[s].resize((streams[s].Size() + blockSize - 1) / blockSize);
+        uint32_t next = 3;
+        auto allocBlock = [&]() { while (IsFPMBlock(next, blockSize)) ++next; return next++; };
+        std::vector<std::pair<uint32_t, const uint8_t*>> writes; // block -> source data (block sized or shorter)
+        std::vector<uint32_t> writeSizes;
+        for (const BlockRef& r : refs)
+        {
+            uint32_t block = allocBlock();
+            streamBlocks[r.stream][r.index] = block;
+            size_t from = size_t(r.index) * blockSize;
+            writes.push_back({ block, streams[r.stream].data.data() + from });
+            writeSizes.push_back(uint32_t(std::min<size_t>(blockSize, streams[r.stream].Size() - from)));
+        }
+
+        // stream directory
+        Buffer dir;
+        dir.U32(uint32_t(streams.size()));
+        for (const Buffer& s : streams)
+            dir.U32(uint32_t(s.Size()));
+        for (const auto& blocks : streamBlocks)
+            for (uint32_t b : blocks)
+                dir.U32(b);
+        std::vector<uint32_t> dirBlocks;
+        for (size_t i = 0; i < dir.Size(); i += blockSize)
+        {
+            uint32_t block = allocBlock();
+            dirBlocks.push_back(block);
+            writes.push_back({ block, dir.data.data() + i });
+            writeSizes.push_back(uint32_t(std::min<size_t>(blockSize, dir.Size() - i)));
+        }
+        // block(s) holding the directory block indices
+        Buffer dirIndices;
+        for (uint32_t b : dirBlocks)
+            dirIndices.U32(b);
+        std::vector<uint32_t> dirIndexBlocks;
+        for (size_t i = 0; i < dirIndices.Size(); i += blockSize)
+        {
+            uint32_t block = allocBlock();
+            dirIndexBlocks.push_back(block);
+            writes.push_back({ block, dirIndices.data.data() + i });
+            writeSizes.push_back(uint32_t(std::min<size_t>(blockSize, dirIndices.Size() - i)));
+        }
+        uint32_t blockCount = next;
+        if (blockCount % blockSize > 0 && blockCount % blockSize <= 2)
+            blockCount += 3 - blockCount % blockSize;
+
+        // super block
+        Buffer super;
+        static const char kMagic[32] = "Microsoft C/C++ MSF 7.00\r\n\x1a\x44\x53\0\0";
+        super.Bytes(kMagic, 32);
+        super.U32(blockSize);
+        super.U32(1); // free block map index
+        super.U32(blockCount);
+        super.U32(uint32_t(dir.Size()));
+        super.U32(0);
+        for (uint32_t b : dirIndexBlocks)
+            super.U32(b);
+        if (super.Size() > blockSize)
+        {
+            fprintf(stderr, "ERROR: stream directory too large for block size %u\n", blockSize);
+            return false;
+        }
+
+        FILE* f = fopen(path, "wb");
+        if (!f)
+        {
+            fprintf(stderr, "ERROR: failed to create '%s'\n", path);
+            return false;
+        }
+        // blocks are written in physical order; free page map blocks mark everything as used (zero bits)
+        std::vector<size_t> order(writes.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return writes[a].first < writes[b].first; });
+        std::vector<uint8_t> block(blockSize, 0);
+        auto putBlock = [&](const uint8_t* src, uint32_t size) {
+            memset(block.data(), 0, blockSize);
+            if (size)
+                memcpy(block.data(), src, size);
+            fwrite(block.data(), 1, blockSize, f);
+        };
+        putBlock(super.data.data(), uint32_t(super.Size()));
+        uint32_t written = 1;
+        for (size_t i : order)
+        {
+            while (written < writes[i].first)
+            {
+                putBlock(nullptr, 0);
+                ++written;
+            }
+            putBlock(writes[i].second, writeSizes[i]);
+            ++written;
+        }
+        while (written < blockCount)
+        {
+            putBlock(nullptr, 0);
+            ++written;
+        }
+        bool ok = ferror(f) == 0;
+        ok &= fclose(f) == 0;
+        if (!ok)
+            fprintf(stderr, "ERROR: failed to write '%s'\n", path);
+        return ok;
+    }
+};
+
+// ------------------------------------------------------------------------------------------------
+
+static void WriteSymbolRecord(Buffer& b, const Symbol& sym)
+{
+    size_t at = b.BeginRecord(sym.kind);
+    switch (sym.kind)
+    {
+    case S_LPROC32: case S_GPROC32: case S_GPROC32_ID:
+        b.U32(0); b.U32(0); b.U32(0); // parent, end, next
+        b.U32(sym.codeSize);
+        b.U32(0); b.U32(sym.codeSize); // debug start/end
+        b.U32(sym.typeIndex);
+        b.U32(sym.offset);
+        b.U16(sym.section);
+        b.U8(0); // flags
+        b.Str(sym.name);
+        break;
+    case S_LDATA32: case S_GDATA32: case S_LTHREAD32: case S_GTHREAD32:
+        b.U32(sym.typeIndex);
+        b.U32(sym.offset);
+        b.U16(sym.section);
+        b.Str(sym.name);
+        break;
+    case S_PUB32:
+        b.U32(sym.typeIndex); // flags
+        b.U32(sym.offset);
+        b.U16(sym.section);
+        b.Str(sym.name);
+        break;
+    }
+    b.EndRecord(at, false);
+}
+
+// Each module with symbols takes an MSF stream, and stream / module indices are 16 bit;
+// scaling past this many modules puts more symbols and contributions into each instead.
+static const uint32_t kMaxModuleCount = 60000;
+
+bool GeneratePDB(const GenOptions& opt, const char* path)
+{
+    Random rnd(opt.seed);
+
+    GenOptions o = opt;
+    uint64_t moduleCount64 = uint64_t(opt.moduleCount) * opt.scale;
+    uint32_t perModuleScale = 1;
+    if (moduleCount64 > kMaxModuleCount)
+    {
+        perModuleScale = uint32_t((moduleCount64 + kMaxModuleCount - 1) / kMaxModuleCount);
+        moduleCount64 /= perModuleScale;
+        o.functionsPerModule *= perModuleScale;
+        o.dataPerModule *= perModuleScale;
+        o.publicOnlyPerModule *= perModuleScale;
+        o.contribsPerModule *= perModuleScale;
+    }
+    const uint32_t moduleCount = uint32_t(moduleCount64);
+    const uint32_t typeCount = opt.typeCount * opt.scale;
+    o.typeCount = typeCount;
+
+    // types
+    TypeStream types;
+    types.Generate(rnd, o);
+
+    // modules, their contributions and symbols
+    std::vector<Module> modules(moduleCount);
+    std::vector<Contrib> contribs;
+    std::vector<Symbol> globals; // go into the global symbol stream
+    std::vector<Symbol> publics;
+    uint32_t sectionSize[kSecCount + 1] = {};
+    for (uint32_t m = 0; m < moduleCount; ++m)
+    {
+        Module& mod = modules[m];
+        mod.name = MakeModulePath(rnd, o, m);
+        mod.objName = rnd.Chance(0.2f) ? std::string("C:\\lib\\") + MakeIdentifier(rnd, o) + ".lib" : mod.name;
+        mod.hasSymbols = !rnd.Chance(0.03f);
+
+        uint32_t contribCount = std::max(1u, rnd.Range(o.contribsPerModule / 2, o.contribsPerModule * 3 / 2));
+        uint32_t funcsLeft = rnd.Range(o.functionsPerModule / 2, o.functionsPerModule * 3 / 2);
+        uint32_t dataLeft = rnd.Range(o.dataPerModule / 2, o.dataPerModule * 3 / 2);
+        uint32_t pubLeft = rnd.Range(0, o.publicOnlyPerModule * 2);
+        for (uint32_t c = 0; c < contribCount; ++c)
+        {
+            uint32_t pick = rnd.Range(0, 9);
+            uint16_t sec = pick < 6 ? kSecText : pick < 7 ? kSecRData : pick < 9 ? kSecData : kSecBSS;
+            bool last = c == contribCount - 1;
+            Contrib ctr;
+            ctr.section = sec;
+            ctr.offset = sectionSize[sec];
+            ctr.module = uint16_t(m);
+            uint32_t cursor = ctr.offset;
+            if (sec == kSecText)
+            {
+                uint32_t n = last ? funcsLeft : rnd.Range(0, funcsLeft);
+                funcsLeft -= n;
+                uint32_t p = last ? pubLeft : rnd.Range(0, pubLeft);
+                pubLeft -= p;
+                for (uint32_t i = 0; i < n + p; ++i)
+                {
+                    Symbol s;
+                    s.name = MakeSymbolName(rnd, o);
+                    s.section = sec;
+                    s.offset = cursor;
+                    s.codeSize = rnd.Chance(0.02f) ? rnd.Range(8192, 200000) : rnd.Range(1, 2000);
+                    s.typeIndex = 0;
+                    cursor += (s.codeSize + 15) & ~15u;
+                    if (i < n)
+                    {
+                        s.kind = rnd.Chance(0.3f) ? S_LPROC32 : rnd.Chance(0.5f) ? S_GPROC32 : S_GPROC32_ID;
+                        if (mod.hasSymbols)
+                            mod.symbols.push_back(s);
+                        // most functions also have a public symbol at the same address
+                        if (s.kind != S_LPROC32 && rnd.Chance(0.8f))
+                        {
+                            Symbol pub = s;
+                            pub.kind = S_PUB32;
+                            pub.typeIndex = 2 | 1; // Function | Code flags
+                            pub.name = "?" + s.name + "@@YAXXZ";
+                            publics.push_back(pub);
+                        }
+                    }
+                    else
+                    {
+                        // public-only functions, sizes have to be estimated
+                        s.kind = S_PUB32;
+                        s.typeIndex = 2 | 1;
+                        publics.push_back(s);
+                    }
+                }
+                // occasional compiler-generated symbols with zero code size
+                if (n && rnd.Chance(0.05f) && mod.hasSymbols)
+                {
+                    Symbol s = mod.symbols.back();
+                    s.codeSize = 0;
+                    s.kind = S_LPROC32;
+                    mod.symbols.push_back(s);
+                }
+            }
+            else
+            {
+                uint32_t n = last ? dataLeft : rnd.Range(0, dataLeft);
+                dataLeft -= n;
+                for (uint32_t i = 0; i < n; ++i)
+                {
+                    Symbol s;
+                    s.name = MakeSymbolName(rnd, o);
+                    s.section = sec;
+                    s.offset = cursor;
+                    s.codeSize = 0;
+                    s.typeIndex = types.dataTypes[rnd.Range(0, uint32_t(types.dataTypes.size()) - 1)];
+                    cursor += rnd.Chance(0.1f) ? rnd.Range(1, 64) * 1024 : rnd.Range(1, 64) * 8;
+                    uint32_t k = rnd.Range(0, 9);
+                    s.kind = k < 5 ? S_LDATA32 : k < 9 ? S_GDATA32 : (rnd.Chance(0.5f) ? S_LTHREAD32 : S_GTHREAD32);
+                    if (s.kind == S_GDATA32 || s.kind == S_GTHREAD32)
+                        globals.push_back(s);
+                    else if (mod.hasSymbols)
+                        mod.symbols.push_back(s);
+                    if (rnd.Chance(0.3f))
+                    {
+                        // data public symbols are not functions, Sizer should skip them
+                        Symbol pub = s;
+                        pub.kind = S_PUB32;
+                        pub.typeIndex = 0;
+                        publics.push_back(pub);
+                    }
+                }
+                // unnamed local data, often emitted alongside functions
+                if (mod.hasSymbols && rnd.Chance(0.1f))
+                {
+                    Symbol s;
+                    s.kind = S_LDATA32;
+                    s.section = sec;
+                    s.offset = cursor;
+                    s.codeSize = 0;
+                    s.typeIndex = 0x0074;
+                    mod.symbols.push_back(s);
+                    cursor += 4;
+                }
+            }
+            ctr.size = std::max(cursor - ctr.offset + rnd.Range(0, 64), 1u);
+            sectionSize[sec] = (ctr.offset + ctr.size + 15) & ~15u;
+            contribs.push_back(ctr);
+        }
+    }
+    // control-flow guard style symbols in a section that does not exist in the image
+    {
+        Symbol s;
+        s.name = "__guard_fids_table";
+        s.kind = S_PUB32;
+        s.typeIndex = 2 | 1;
+        s.section = kSecCount + 2;
+        s.offset = 0;
+        s.codeSize = 0;
+        publics.push_back(s);
+    }
+    // "* Linker *" module without symbols
+    {
+        Module linker;
+        linker.name = "* Linker *";
+        linker.hasSymbols = false;
+        modules.push_back(linker);
+    }
+
+    std::sort(contribs.begin(), contribs.end(), [](const Contrib& a, const Contrib& b) {
+        if (a.section != b.section)
+            return a.section < b.section;
+        return a.offset < b.offset;
+    });
+
+    MSFWriter msf;
+    msf.blockSize = opt.blockSize;
+    const uint32_t oldDirStream = msf.AddStream();
+    const uint32_t infoStream = msf.AddStream();
+    const uint32_t tpiStream = msf.AddStream();
+    const uint32_t dbiStream = msf.AddStream();
+    const uint32_t ipiStream = msf.AddStream();
+    const uint32_t globalStream = msf.AddStream();
+    const uint32_t publicStream = msf.AddStream();
+    const uint32_t symRecordStream = msf.AddStream();
+    const uint32_t sectionHeaderStream = msf.AddStream();
+    const uint32_t tpiHashStream = msf.AddStream();
+    (void)oldDirStream;
+
+    // PDB info stream
+    {
+        Buffer& b = msf.streams[infoStream];
+        b.U32(20000404); // VC70
+        b.U32(0x5a5a0000 | (opt.seed & 0xffff)); // signature
+        b.U32(1); // age
+        for (int i = 0; i < 4; ++i)
+            b.U32(uint32_t(Random(opt.seed * 31 + i).Next()));
+        b.U32(0); // named stream map string table length
+        b.U32(0); b.U32(1); // hash table size, capacity
+        b.U32(0); // present bit vector word count
+        b.U32(0); // deleted bit vector word count
+        b.U32(0); // niMac
+        b.U32(20140508); // feature code VC140
+    }
+
+    // TPI + hash streams
+    {
+        Buffer& b = msf.streams[tpiStream];
+        Buffer& h = msf.streams[tpiHashStream];
+        uint32_t ioOffset = 0, ioLength = 0;
+        types.WriteHashStream(h, ioOffset, ioLength);
+        b.U32(20040203); // V80
+        b.U32(56); // header size
+        b.U32(kTypeIndexBegin);
+        b.U32(types.NextIndex());
+        b.U32(uint32_t(types.records.Size()));
+        b.U16(uint16_t(tpiHashStream)); b.U16(0xFFFF);
+        b.U32(4); b.U32(0x3FFFF); // hash key size, buckets
+        b.U32(0); b.U32(0); // hash values
+        b.U32(ioOffset); b.U32(ioLength);
+        b.U32(ioOffset + ioLength); b.U32(0); // hash adjusters
+        b.Bytes(types.records.data.data(), types.records.Size());
+    }
+    // IPI: empty, but well formed
+    {
+        Buffer& b = msf.streams[ipiStream];
+        b.U32(20040203); b.U32(56); b.U32(kTypeIndexBegin); b.U32(kTypeIndexBegin); b.U32(0);
+        b.U16(0xFFFF); b.U16(0xFFFF); b.U32(4); b.U32(0x3FFFF);
+        b.Zeros(24);
+    }
+
+    // section headers
+    {
+        Buffer& b = msf.streams[sectionHeaderStream];
+        uint32_t va = 0x1000;
+        for (int s = 0; s < kSecCount; ++s)
+        {
+            char name[8] = {};
+            memcpy(name, kSectionNames[s], strlen(kSectionNames[s]));
+            b.Bytes(name, 8);
+            b.U32(sectionSize[s + 1]); // virtual size
+            b.U32(va);
+            b.U32(s == kSecBSS - 1 ? 0 : sectionSize[s + 1]);
+            b.U32(0); b.U32(0); b.U32(0); b.U16(0); b.U16(0);
+            b.U32(kSectionChars[s]);
+            va += (sectionSize[s + 1] + 0xFFF) & ~0xFFFu;
+            va += 0x1000;
+        }
+    }
+
+    // symbol records referenced by global & public hash streams
+    std::vector<uint32_t> globalOffsets, publicOffsets;
+    {
+        Buffer& b = msf.streams[symRecordStream];
+        for (const Symbol& s : globals)
+        {
+            globalOffsets.push_back(uint32_t(b.Size()));
+            WriteSymbolRecord(b, s);
+        }
+        for (const Symbol& s : publics)
+        {
+            publicOffsets.push_back(uint32_t(b.Size()));
+            WriteSymbolRecord(b, s);
+        }
+    }
+    // hash records are stored in hash bucket order in real PDBs, i.e. pretty much random
+    auto shuffle = [&rnd](std::vector<uint32_t>& v) {
+        for (size_t i = v.size(); i > 1; --i)
+            std::swap(v[i - 1], v[size_t(rnd.Next() % i)]);
+    };
+    shuffle(globalOffsets);
+    shuffle(publicOffsets);
+    auto writeHashTable = [](Buffer& b, const std::vector<uint32_t>& offsets) {
+        b.U32(0xffffffffu);
+        b.U32(0xeffe0000u + 19990810u);
+        b.U32(uint32_t(offsets.size() * 8));
+        b.U32(0); // bucket bitmap/offsets size (not written)
+        for (uint32_t o : offsets)
+        {
+            b.U32(o + 1);
+            b.U32(1);
+        }
+    };
+    writeHashTable(msf.streams[globalStream], globalOffsets);
+    {
+        Buffer& b = msf.streams[publicStream];
+        b.U32(uint32_t(16 + publicOffsets.size() * 8)); // symHash
+        b.U32(0); b.U32(0); b.U32(0); // addrMap, thunks
+        b.U16(0); b.U16(0); b.U32(0); b.U16(kSecCount); b.U16(0);
+        writeHashTable(b, publicOffsets);
+    }
+
+    // module symbol streams & module info substream
+    Buffer moduleInfo;
+    for (Module& mod : modules)
+    {
+        uint16_t streamIndex = 0xFFFF;
+        uint32_t symbolSize = 0;
+        if (mod.hasSymbols)
+        {
+            streamIndex = uint16_t(msf.AddStream());
+            if (streamIndex == 0xFFFF)
+            {
+                fprintf(stderr, "ERROR: too many streams, reduce module count\n");
+                return false;
+            }
+            Buffer& b = msf.streams[streamIndex];
+            b.U32(4); // CV_SIGNATURE_C13
+            {
+                size_t at = b.BeginRecord(S_OBJNAME);
+                b.U32(0);
+                b.Str(mod.name);
+                b.EndRecord(at, false);
+            }
+            for (const Symbol& s : mod.symbols)
+            {
+                WriteSymbolRecord(b, s);
+                if (s.kind == S_LPROC32 || s.kind == S_GPROC32 || s.kind == S_GPROC32_ID)
+                {
+                    size_t at = b.BeginRecord(S_END);
+                    b.EndRecord(at, false);
+                }
+            }
+            symbolSize = uint32_t(b.Size());
+            b.U32(0); // global refs size
+        }
+        moduleInfo.U32(0);
+        moduleInfo.Zeros(28); // section contribution
+        moduleInfo.U16(0); // flags
+        moduleInfo.U16(streamIndex);
+        moduleInfo.U32(symbolSize);
+        moduleInfo.U32(0); moduleInfo.U32(0); // c11, c13
+        moduleInfo.U16(0); moduleInfo.U16(0); moduleInfo.U32(0);
+        moduleInfo.U32(0); moduleInfo.U32(0);
+        moduleInfo.Str(mod.name);
+        moduleInfo.Str(mod.objName);
+        moduleInfo.Align(4);
+    }
+
+    // DBI stream
+    {
+        Buffer contribBuf;
+        contribBuf.U32(0xeffe0000u + 19970605u); // Ver60
+        for (const Contrib& c : contribs)
+        {
+            contribBuf.U16(c.section); contribBuf.U16(0);
+            contribBuf.U32(c.offset);
+            contribBuf.U32(c.size);
+            contribBuf.U32(kSectionChars[c.section - 1]);
+            contribBuf.U16(c.module); contribBuf.U16(0);
+            contribBuf.U32(0); contribBuf.U32(0);
+        }
+        Buffer debugHeader;
+        for (int i = 0; i < 11; ++i)
+            debugHeader.U16(i == 5 ? uint16_t(sectionHeaderStream) : 0xFFFF);
+
+        Buffer& b = msf.streams[dbiStream];
+        b.U32(0xffffffffu);
+        b.U32(19990903); // V70
+        b.U32(1); // age
+        b.U16(uint16_t(globalStream)); b.U16(0x8e00);
+        b.U16(uint16_t(publicStream)); b.U16(0);
+        b.U16(uint16_t(symRecordStream)); b.U16(0);
+        b.U32(uint32_t(moduleInfo.Size()));
+        b.U32(uint32_t(contribBuf.Size()));
+        b.U32(0); // section map
+        b.U32(0); // source info
+        b.U32(0); // type server map
+        b.U32(0); // MFC type server
+        b.U32(uint32_t(debugHeader.Size()));
+        b.U32(0); // EC
+        b.U16(0); // flags
+        b.U16(0x8664); // machine
+        b.U32(0);
+        b.Bytes(moduleInfo.data.data(), moduleInfo.Size());
+        b.Bytes(contribBuf.data.data(), contribBuf.Size());
+        b.Bytes(debugHeader.data.data(), debugHeader.Size());
+    }
+
+    for (const Buffer& s : msf.streams)
+    {
+        if (s.Size() > 0xFFFFFFFFull)
+        {
+            fprintf(stderr, "ERROR: stream larger than 4GB, reduce scale\n");
+            return false;
+        }
+    }
+
+    size_t symbolCount = globals.size() + publics.size();
+    for (const Module& mod : modules)
+        symbolCount += mod.symbols.size();
+    fprintf(stderr, "Writing %s: %u modules, %zu symbol records, %zu contributions, %u types\n",
+        path, uint32_t(modules.size()), symbolCount, contribs.size(), typeCount);
+    return msf.Write(path, rnd, opt.fragmentation);
+}
@@ -0,0 +1,31 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#pragma once
+
+#include <stdint.h>
+
+// Synthetic MSF/PDB generator, for reproducible benchmarks of Sizer. Writes a PDB with the
+// same stream layouts that raw_pdb reads (PDB info, TPI, DBI with module info / section
+// contributions / debug header, GSI, PSI, symbol records, section headers and per-module
+// symbol streams). The same options always produce the same file.
+
+struct GenOptions
+{
+    uint32_t seed = 1;
+    uint32_t scale = 1;
+    uint32_t moduleCount = 2000;
+    uint32_t functionsPerModule = 60;
+    uint32_t dataPerModule = 12;
+    uint32_t contribsPerModule = 8;
+    uint32_t publicOnlyPerModule = 6;
+    uint32_t typeCount = 50000;
+    uint32_t nameMinLength = 4;
+    uint32_t nameMaxLength = 24;
+    uint32_t templateDepth = 3;
+    uint32_t blockSize = 4096;
+    float fragmentation = 0.0f;
+};
+
+bool GeneratePDB(const GenOptions& opt, const char* path);
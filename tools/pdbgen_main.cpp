@@ -0,0 +1,99 @@
+// Executable size report utility.
+// Aras Pranckevicius, https://aras-p.info/projSizer.html
+// Public domain.
+
+#include "pdbgen.hpp"
+#include "parg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+
+static void print_help()
+{
+    GenOptions def;
+    fprintf(stderr, "Usage: SizerGenPDB [options] output.pdb\n");
+    fprintf(stderr, " -x n   or --scale=n          Multiply module and type counts, e.g. 10 or 100 (default %u)\n", def.scale);
+    fprintf(stderr, " -s n   or --seed=n           Random seed (default %u)\n", def.seed);
+    fprintf(stderr, " -M n   or --modules=n        Module count (default %u)\n", def.moduleCount);
+    fprintf(stderr, " -f n   or --functions=n      Average functions per module (default %u)\n", def.functionsPerModule);
+    fprintf(stderr, " -d n   or --data=n           Average data symbols per module (default %u)\n", def.dataPerModule);
+    fprintf(stderr, " -p n   or --publics=n        Average public-only functions per module (default %u)\n", def.publicOnlyPerModule);
+    fprintf(stderr, " -c n   or --contribs=n       Average section contributions per module (default %u)\n", def.contribsPerModule);
+    fprintf(stderr, " -t n   or --types=n          Type record count in TPI stream (default %u)\n", def.typeCount);
+    fprintf(stderr, " -l n   or --namemin=n        Minimum identifier length (default %u)\n", def.nameMinLength);
+    fprintf(stderr, " -L n   or --namemax=n        Maximum identifier length (default %u)\n", def.nameMaxLength);
+    fprintf(stderr, " -D n   or --templatedepth=n  Maximum template nesting depth (default %u)\n", def.templateDepth);
+    fprintf(stderr, " -b n   or --blocksize=n      MSF block size (default %u)\n", def.blockSize);
+    fprintf(stderr, " -r f   or --fragment=f       Fraction of MSF blocks to scatter, 0..1 (default %.1f)\n", def.fragmentation);
+    fprintf(stderr, " -h or --help                 Print this help\n");
+}
+
+int main(int argc, char* const* argv)
+{
+    GenOptions opt;
+    std::string outFile;
+
+    parg_state args;
+    parg_init(&args);
+    static const struct parg_option argsTable[] =
+    {
+        { "scale", PARG_REQARG, NULL, 'x' },
+        { "seed", PARG_REQARG, NULL, 's' },
+        { "modules", PARG_REQARG, NULL, 'M' },
+        { "functions", PARG_REQARG, NULL, 'f' },
+        { "data", PARG_REQARG, NULL, 'd' },
+        { "publics", PARG_REQARG, NULL, 'p' },
+        { "contribs", PARG_REQARG, NULL, 'c' },
+        { "types", PARG_REQARG, NULL, 't' },
+        { "namemin", PARG_REQARG, NULL, 'l' },
+        { "namemax", PARG_REQARG, NULL, 'L' },
+        { "templatedepth", PARG_REQARG, NULL, 'D' },
+        { "blocksize", PARG_REQARG, NULL, 'b' },
+        { "fragment", PARG_REQARG, NULL, 'r' },
+        { "help", PARG_NOARG, NULL, 'h' },
+        { 0, 0, 0, 0 }
+    };
+    int c;
+    while ((c = parg_getopt_long(&args, argc, argv, "x:s:M:f:d:p:c:t:l:L:D:b:r:h", argsTable, NULL)) != -1)
+    {
+        switch (c)
+        {
+        case 1: outFile = args.optarg; break;
+        case 'x': opt.scale = std::max(1, atoi(args.optarg)); break;
+        case 's': opt.seed = uint32_t(atoi(args.optarg)); break;
+        case 'M': opt.moduleCount = std::max(1, atoi(args.optarg)); break;
+        case 'f': opt.functionsPerModule = uint32_t(atoi(args.optarg)); break;
+        case 'd': opt.dataPerModule = uint32_t(atoi(args.optarg)); break;
+        case 'p': opt.publicOnlyPerModule = uint32_t(atoi(args.optarg)); break;
+        case 'c': opt.contribsPerModule = std::max(1, atoi(args.optarg)); break;
+        case 't': opt.typeCount = uint32_t(atoi(args.optarg)); break;
+        case 'l': opt.nameMinLength = std::max(1, atoi(args.optarg)); break;
+        case 'L': opt.nameMaxLength = std::max(1, atoi(args.optarg)); break;
+        case 'D': opt.templateDepth = uint32_t(atoi(args.optarg)); break;
+        case 'b': opt.blockSize = uint32_t(atoi(args.optarg)); break;
+        case 'r': opt.fragmentation = float(atof(args.optarg)); break;
+        case '?':
+            fprintf(stderr, "Unknown argument or missing value for '%c'\n", args.optopt);
+            // fall through
+        case 'h':
+        default:
+            print_help();
+            return 0;
+        }
+    }
+    if (outFile.empty())
+    {
+        print_help();
+        return 0;
+    }
+    if (opt.nameMaxLength < opt.nameMinLength)
+        opt.nameMaxLength = opt.nameMinLength;
+    if (opt.blockSize < 512 || (opt.blockSize & (opt.blockSize - 1)) != 0)
+    {
+        fprintf(stderr, "ERROR: block size must be a power of two, at least 512\n");
+        return 1;
+    }
+
+    return GeneratePDB(opt, outFile.c_str()) ? 0 : 1;
+}
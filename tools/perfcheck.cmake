@@ -0,0 +1,240 @@
+# Executable size report utility.
+# Aras Pranckevicius, https://aras-p.info/projSizer.html
+# Public domain.
+#
+# End to end performance check: runs Sizer with --stats=json over a corpus of PDB files
+# several times, takes the median wall time of each phase and the median peak memory use,
+# and compares them against a baseline file. Fails when anything got slower / bigger than
+# the baseline by more than the tolerance. Usually run through the SizerPerfCheck target:
+#
+#   cmake --build build --target SizerPerfCheck
+#
+# or directly, with -D options before -P:
+#
+#   cmake -DSIZER=path/to/Sizer -DGENPDB=path/to/SizerGenPDB -P tools/perfcheck.cmake
+#
+# Options:
+#   SIZER              Sizer executable (required)
+#   GENPDB             SizerGenPDB executable, needed for generated PDBs
+#   GENERATE           generated PDB scales to include, e.g. "1;10" (default "1;10")
+#   CORPUS             other PDB files to include
+#   RUNS               runs of each PDB (default 3)
+#   SIZER_ARGS         extra Sizer arguments (default "-j;1")
+#   BASELINE           baseline file (default perf_baseline.json next to this script)
+#   TOLERANCE_PERCENT  allowed regression (default 25)
+#   MIN_DELTA_MS       differences smaller than this never fail, against timer noise (default 5)
+#   UPDATE_BASELINE    write the results as the new baseline instead of comparing
+#   WORK_DIR           where generated PDBs and reports go (default current directory)
+#
+# Timings depend a lot on the machine: the checked-in baseline is only meaningful on the
+# machine it was made on. Make one with UPDATE_BASELINE=ON before changes, then compare.
+
+cmake_minimum_required(VERSION 3.21)
+
+if (NOT SIZER)
+	message(FATAL_ERROR "SIZER (path to the Sizer executable) is required")
+endif()
+if (NOT DEFINED GENERATE)
+	set(GENERATE "1;10")
+endif()
+if (NOT RUNS)
+	set(RUNS 3)
+endif()
+if (NOT DEFINED SIZER_ARGS)
+	set(SIZER_ARGS "-j;1")
+endif()
+if (NOT BASELINE)
+	set(BASELINE "${CMAKE_CURRENT_LIST_DIR}/perf_baseline.json")
+endif()
+if (NOT DEFINED TOLERANCE_PERCENT)
+	set(TOLERANCE_PERCENT 25)
+endif()
+if (NOT DEFINED MIN_DELTA_MS)
+	set(MIN_DELTA_MS 5)
+endif()
+if (NOT WORK_DIR)
+	set(WORK_DIR "${CMAKE_CURRENT_BINARY_DIR}")
+endif()
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+# "12.345" milliseconds -> 12345 microseconds; CMake math is integer only. Numbers come
+# from string(JSON), which can print them as e.g. "12.345000000000001" or "1e-05".
+function(ms_to_us ms outVar)
+	set(us 0)
+	if (ms MATCHES "^([0-9]+)(\\.([0-9]*))?$")
+		set(frac "${CMAKE_MATCH_3}000")
+		string(SUBSTRING "${frac}" 0 3 frac)
+		math(EXPR us "${CMAKE_MATCH_1} * 1000 + 1${frac} - 1000") # "1" prefix keeps leading zeros decimal
+	endif()
+	set(${outVar} ${us} PARENT_SCOPE)
+endfunction()
+
+function(median values outVar)
+	list(SORT values COMPARE NATURAL)
+	list(LENGTH values count)
+	math(EXPR mid "${count} / 2")
+	list(GET values ${mid} result)
+	set(${outVar} ${result} PARENT_SCOPE)
+endfunction()
+
+function(format_ms us outVar)
+	math(EXPR whole "${us} / 1000")
+	math(EXPR frac "(${us} % 1000) / 10")
+	if (frac LESS 10)
+		set(frac "0${frac}")
+	endif()
+	set(${outVar} "${whole}.${frac}" PARENT_SCOPE)
+endfunction()
+
+# Runs Sizer on pdb RUNS times; sets <prefix>_PHASES (phase paths like "read PDB/module symbols",
+# in the order they ran), <prefix>_<phase id> (median wall time in microseconds of each) and
+# <prefix>_PEAK_RSS (median peak memory use in bytes) in the parent scope.
+function(measure pdb prefix)
+	set(phases "")
+	set(peaks "")
+	foreach(run RANGE 1 ${RUNS})
+		execute_process(
+			COMMAND "${SIZER}" "${pdb}" --stats=json ${SIZER_ARGS}
+			OUTPUT_FILE "${WORK_DIR}/perfcheck-report.txt"
+			ERROR_VARIABLE err
+			RESULT_VARIABLE result)
+		if (NOT result EQUAL 0)
+			message(FATAL_ERROR "Sizer failed on ${pdb}:\n${err}")
+		endif()
+		string(FIND "${err}" "{\"phases\":" start)
+		if (start LESS 0)
+			message(FATAL_ERROR "No --stats=json output from Sizer on ${pdb}:\n${err}")
+		endif()
+		string(SUBSTRING "${err}" ${start} -1 json)
+
+		string(JSON count LENGTH "${json}" phases)
+		math(EXPR last "${count} - 1")
+		set(stack "")
+		set(peak 0)
+		foreach(i RANGE ${last})
+			string(JSON name GET "${json}" phases ${i} name)
+			string(JSON depth GET "${json}" phases ${i} depth)
+			string(JSON wall GET "${json}" phases ${i} wall_ms)
+			string(JSON rss GET "${json}" phases ${i} peak_rss_bytes)
+			list(SUBLIST stack 0 ${depth} stack)
+			list(APPEND stack "${name}")
+			list(JOIN stack "/" path)
+			string(MAKE_C_IDENTIFIER "${path}" id)
+			if (NOT "${path}" IN_LIST phases)
+				list(APPEND phases "${path}")
+			endif()
+			ms_to_us(${wall} us)
+			list(APPEND times_${id} ${us})
+			if (rss GREATER peak)
+				set(peak ${rss})
+			endif()
+		endforeach()
+		list(APPEND peaks ${peak})
+	endforeach()
+
+	foreach(path IN LISTS phases)
+		string(MAKE_C_IDENTIFIER "${path}" id)
+		median("${times_${id}}" med)
+		set(${prefix}_${id} ${med} PARENT_SCOPE)
+	endforeach()
+	median("${peaks}" peak)
+	set(${prefix}_PHASES "${phases}" PARENT_SCOPE)
+	set(${prefix}_PEAK_RSS ${peak} PARENT_SCOPE)
+endfunction()
+
+# the corpus: generated PDBs first, then given ones
+set(entries "")
+foreach(scale IN LISTS GENERATE)
+	if (NOT GENPDB)
+		message(FATAL_ERROR "GENPDB (path to the SizerGenPDB executable) is required for generated PDBs")
+	endif()
+	set(pdb "${WORK_DIR}/perfcheck-x${scale}.pdb")
+	# the generator is deterministic, so an existing file is the same one
+	if (NOT EXISTS "${pdb}")
+		execute_process(COMMAND "${GENPDB}" --scale=${scale} "${pdb}" RESULT_VARIABLE result)
+		if (NOT result EQUAL 0)
+			message(FATAL_ERROR "Failed to generate ${pdb}")
+		endif()
+	endif()
+	list(APPEND entries "generated-x${scale}")
+	set(pdb_generated-x${scale} "${pdb}")
+endforeach()
+foreach(pdb IN LISTS CORPUS)
+	get_filename_component(name "${pdb}" NAME)
+	list(APPEND entries "${name}")
+	set(pdb_${name} "${pdb}")
+endforeach()
+if (NOT entries)
+	message(FATAL_ERROR "Nothing to measure: GENERATE and CORPUS are both empty")
+endif()
+
+set(baselineJson "{}")
+if (NOT UPDATE_BASELINE)
+	if (NOT EXISTS "${BASELINE}")
+		message(FATAL_ERROR "No baseline file ${BASELINE}; make one with -DUPDATE_BASELINE=ON")
+	endif()
+	file(READ "${BASELINE}" baselineJson)
+endif()
+
+set(newBaseline "{}")
+set(failures "")
+foreach(entry IN LISTS entries)
+	message(STATUS "Measuring ${entry}, ${RUNS} runs ...")
+	measure("${pdb_${entry}}" cur)
+
+	string(JSON entryJson SET "{}" peak_rss_bytes ${cur_PEAK_RSS})
+	string(JSON entryJson SET "${entryJson}" wall_us "{}")
+	foreach(path IN LISTS cur_PHASES)
+		string(MAKE_C_IDENTIFIER "${path}" id)
+		string(JSON entryJson SET "${entryJson}" wall_us "${path}" ${cur_${id}})
+	endforeach()
+	string(JSON newBaseline SET "${newBaseline}" "${entry}" "${entryJson}")
+	if (UPDATE_BASELINE)
+		continue()
+	endif()
+
+	string(JSON base ERROR_VARIABLE missing GET "${baselineJson}" "${entry}")
+	if (missing)
+		message(STATUS "  not in baseline, skipped")
+		continue()
+	endif()
+	math(EXPR minDelta "${MIN_DELTA_MS} * 1000")
+	foreach(path IN LISTS cur_PHASES)
+		string(MAKE_C_IDENTIFIER "${path}" id)
+		string(JSON baseUs ERROR_VARIABLE missing GET "${base}" wall_us "${path}")
+		if (missing)
+			continue()
+		endif()
+		set(curUs ${cur_${id}})
+		format_ms(${curUs} curMs)
+		format_ms(${baseUs} baseMs)
+		math(EXPR limit "${baseUs} * (100 + ${TOLERANCE_PERCENT}) / 100")
+		math(EXPR delta "${curUs} - ${baseUs}")
+		set(status "")
+		if (curUs GREATER limit AND delta GREATER minDelta)
+			set(status "  <-- REGRESSION")
+			list(APPEND failures "${entry}: ${path} ${baseMs} -> ${curMs} ms")
+		endif()
+		message(STATUS "  ${path}: ${curMs} ms (baseline ${baseMs})${status}")
+	endforeach()
+	string(JSON baseRss GET "${base}" peak_rss_bytes)
+	math(EXPR limit "${baseRss} / 100 * (100 + ${TOLERANCE_PERCENT})")
+	math(EXPR curMB "${cur_PEAK_RSS} / 1048576")
+	math(EXPR baseMB "${baseRss} / 1048576")
+	set(status "")
+	if (cur_PEAK_RSS GREATER limit)
+		set(status "  <-- REGRESSION")
+		list(APPEND failures "${entry}: peak memory ${baseMB} -> ${curMB} MB")
+	endif()
+	message(STATUS "  peak memory: ${curMB} MB (baseline ${baseMB})${status}")
+endforeach()
+
+if (UPDATE_BASELINE)
+	file(WRITE "${BASELINE}" "${newBaseline}\n")
+	message(STATUS "Wrote baseline ${BASELINE}")
+elseif (failures)
+	list(JOIN failures "\n  " text)
+	message(FATAL_ERROR "Performance regressions beyond ${TOLERANCE_PERCENT}%:\n  ${text}")
+else()
+	message(STATUS "No regressions beyond ${TOLERANCE_PERCENT}%")
+endif()